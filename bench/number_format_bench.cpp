@@ -0,0 +1,114 @@
+// NumberFormat against the iostream and std::sto* conversions it replaced,
+// on the same random values, so one run gives both sides of the comparison.
+
+#include "number_format.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Lizard;
+
+namespace {
+
+constexpr int COUNT = 2000000;
+
+template<typename F>
+void measure(const char* label, F&& body) {
+    auto start = std::chrono::steady_clock::now();
+    size_t checksum = body();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::printf("  %-22s %7.0f ms (checksum %zu)\n", label, ms, checksum);
+}
+
+} // namespace
+
+int main() {
+    std::mt19937_64 random(42);
+    std::uniform_real_distribution<double> real(-1e6, 1e6);
+    std::vector<double> floats(COUNT);
+    std::vector<int64_t> ints(COUNT);
+    for (int i = 0; i < COUNT; ++i) {
+        floats[i] = real(random);
+        ints[i] = static_cast<int64_t>(random()) >> (random() % 48);
+    }
+
+    std::vector<std::string> float_texts, int_texts;
+    for (int i = 0; i < COUNT; ++i) {
+        float_texts.push_back(std::to_string(floats[i]));
+        int_texts.push_back(std::to_string(ints[i]));
+    }
+
+    std::printf("format float:\n");
+    measure("ostringstream", [&] {
+        size_t total = 0;
+        for (double f : floats) {
+            std::ostringstream out;
+            out << f;
+            total += out.str().size();
+        }
+        return total;
+    });
+    measure("NumberFormat", [&] {
+        size_t total = 0;
+        char buffer[NumberFormat::MAX_CHARS];
+        for (double f : floats) {
+            total += static_cast<size_t>(NumberFormat::formatFloat(buffer, f) - buffer);
+        }
+        return total;
+    });
+
+    std::printf("format int:\n");
+    measure("std::to_string", [&] {
+        size_t total = 0;
+        for (int64_t i : ints) {
+            total += std::to_string(i).size();
+        }
+        return total;
+    });
+    measure("NumberFormat", [&] {
+        size_t total = 0;
+        char buffer[NumberFormat::MAX_CHARS];
+        for (int64_t i : ints) {
+            total += static_cast<size_t>(NumberFormat::formatInt(buffer, i) - buffer);
+        }
+        return total;
+    });
+
+    std::printf("parse float:\n");
+    measure("std::stod", [&] {
+        size_t total = 0;
+        for (const std::string& text : float_texts) {
+            total += static_cast<size_t>(std::stod(text) != 0);
+        }
+        return total;
+    });
+    measure("NumberFormat", [&] {
+        size_t total = 0;
+        for (const std::string& text : float_texts) {
+            double value;
+            total += NumberFormat::parseFloat(text, value) == NumberFormat::ParseStatus::OK && value != 0;
+        }
+        return total;
+    });
+
+    std::printf("parse int:\n");
+    measure("std::stoll", [&] {
+        size_t total = 0;
+        for (const std::string& text : int_texts) {
+            total += static_cast<size_t>(std::stoll(text) & 1);
+        }
+        return total;
+    });
+    measure("NumberFormat", [&] {
+        size_t total = 0;
+        for (const std::string& text : int_texts) {
+            int64_t value;
+            total += NumberFormat::parseInt(text, value) == NumberFormat::ParseStatus::OK && (value & 1);
+        }
+        return total;
+    });
+    return 0;
+}
@@ -0,0 +1,43 @@
+// Cost of one binary operation on Values through ArithmeticEvaluator, the
+// path both engines take for arithmetic they cannot specialize. Also prints
+// the sizes that decide how many Values and Variables fit in a cache line.
+//
+// Only uses API that predates the NaN-boxed Value, so building it at the
+// commit before that change reproduces the "before" numbers.
+
+#include "environment.h"
+#include "eval_arithmetic.h"
+#include "value.h"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using namespace Lizard;
+
+int main() {
+    constexpr int ITERATIONS = 20000000;
+    const BinaryOperator ops[] = {
+        BinaryOperator::ADD, BinaryOperator::MULTIPLY, BinaryOperator::MODULO, BinaryOperator::SUBTRACT
+    };
+
+    // Small operands, so integer results never leave the immediate range
+    std::vector<Value> operands;
+    for (int i = 1; i <= 64; ++i) {
+        operands.push_back(i % 2 ? Value(i) : Value(i * 0.5));
+    }
+
+    Position pos;
+    size_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; ++i) {
+        const Value& left = operands[i & 63];
+        const Value& right = operands[(i >> 6) & 63];
+        Value result = ArithmeticEvaluator::evaluate(ops[i & 3], left, right, pos);
+        checksum += static_cast<size_t>(result.getType());
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("sizeof(Value)=%zu, sizeof(Variable)=%zu\n", sizeof(Value), sizeof(Variable));
+    std::printf("%.1f ns/op (checksum %zu)\n", seconds * 1e9 / ITERATIONS, checksum);
+    return 0;
+}
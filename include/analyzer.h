@@ -0,0 +1,54 @@
+#pragma once
+#include "ast.h"
+#include "environment.h"
+#include <vector>
+
+namespace Lizard {
+
+// Whole-program analysis run after the Resolver.
+//
+// Reads of a `fix` constant that come after its declaration are replaced by
+// the literal it was initialized with, and expressions that become constant
+// are folded. The declaration itself still runs, so redefinition,
+// reassignment and use-before-init errors are raised exactly as before.
+//
+// Every slot then gets the join of the types of all values written to it.
+// Binary expressions whose operand types are both known are annotated so
+// the engines can call the matching arithmetic kernel directly.
+//
+// A prelude the program will start on top of counts as written before the
+// first statement: its initialized `fix` slots are propagated like any
+// other, and every initialized slot starts with its value's type.
+class StaticAnalyzer {
+public:
+    void analyze(Program& program, const std::vector<Variable>* prelude = nullptr);
+
+private:
+    static constexpr uint32_t NO_CONSTANT = UINT32_MAX;
+
+    // A ValueType, or one of the lattice ends: NONE (no value is ever
+    // produced) and ANY (more than one type is possible)
+    using StaticType = uint8_t;
+    static constexpr StaticType NONE = 0;
+    static constexpr StaticType ANY = 0xFF;
+
+    Program* program = nullptr;
+    const std::vector<Variable>* prelude = nullptr;
+    std::vector<bool> is_target;          // identifiers written by their statement
+    std::vector<uint32_t> fixed_values;   // per slot: constant index, or NO_CONSTANT
+    std::vector<StaticType> node_types;
+    std::vector<StaticType> slot_types;
+
+    void markTargets();
+    void propagateConstants();
+    uint32_t preludeConstant(uint32_t slot);
+    void inferTypes();
+
+    static StaticType typeOf(ValueType type) { return static_cast<StaticType>(type) + 1; }
+    static bool isConcrete(StaticType type) { return type != NONE && type != ANY; }
+    static ValueType valueType(StaticType type) { return static_cast<ValueType>(type - 1); }
+    static StaticType join(StaticType a, StaticType b);
+    static StaticType resultType(BinaryOperator op, StaticType left, StaticType right);
+};
+
+} // namespace Lizard
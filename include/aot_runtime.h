@@ -0,0 +1,67 @@
+#pragma once
+#include "ast.h"
+#include "environment.h"
+#include "eval_arithmetic.h"
+#include "output_buffer.h"
+#include "value.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Lizard {
+
+// State of a program that `lizard --emit-cpp` translated to C++. The
+// generated code calls these members in the order the interpreter would
+// evaluate the program, so values, output and error messages match it.
+// Positions are passed as line and column; the file is always the
+// embedded source.
+class CompiledProgram {
+public:
+    // Statements are emitted as a sequence of functions to keep each one
+    // small enough for the C++ compiler
+    using Part = void (*)(CompiledProgram& program);
+
+    // `source` is the text of the original file, used to format errors
+    CompiledProgram(const std::string& filename, std::string_view source,
+                    const std::vector<std::string>& slot_names);
+
+    // Runs every part with the interpreter's output buffering, error
+    // reporting and exit status. Accepts the interpreter's --unbuffered.
+    int run(int argc, char* argv[], const Part* parts, size_t count);
+
+    std::vector<Value> constants;
+
+    Position position(int line, int column) const { return Position(file_id, line, column); }
+
+    void define(uint32_t slot, const Value& value, bool is_constant, int line, int column) {
+        environment.define(slot, value, is_constant, true, position(line, column));
+    }
+    void declare(uint32_t slot, bool is_constant, int line, int column) {
+        environment.define(slot, Value(nullptr), is_constant, false, position(line, column));
+    }
+    void assign(uint32_t slot, const Value& value, int line, int column) {
+        environment.assign(slot, value, position(line, column));
+    }
+    const Value& get(uint32_t slot, int line, int column) const {
+        return environment.get(slot, position(line, column));
+    }
+    void print(const Value& value) { output.writeLine(value); }
+
+    Value binary(BinaryOperator op, const Value& left, const Value& right, int line, int column) const {
+        return ArithmeticEvaluator::evaluate(op, left, right, position(line, column));
+    }
+    Value binary(BinaryOperator op, TypePair types, const Value& left, const Value& right,
+                 int line, int column) const {
+        return ArithmeticEvaluator::evaluate(op, types, left, right, position(line, column));
+    }
+
+private:
+    std::vector<std::string> slot_names;
+    uint32_t file_id;
+    Environment environment;
+    OutputBuffer output;
+};
+
+} // namespace Lizard
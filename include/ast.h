@@ -1,15 +1,19 @@
 #pragma once
 #include "token.h"
-#include <memory>
+#include "constant_pool.h"
+#include <cstdint>
+#include <string>
 #include <vector>
 
 namespace Lizard {
 
-struct ASTNode;
-using ASTNodePtr = std::unique_ptr<ASTNode>;
+// Nodes live in one contiguous vector per Program and refer to each other
+// by index. Children are always emitted before their parents, so every
+// statement's expression tree sits in a compact run just before it.
+using NodeIndex = uint32_t;
+constexpr NodeIndex NO_NODE = UINT32_MAX;
 
-enum class ASTNodeType {
-    PROGRAM,
+enum class ASTNodeType : uint8_t {
     VARIABLE_DECLARATION,
     VARIABLE_ASSIGNMENT,
     PRINT_STATEMENT,
@@ -18,7 +22,7 @@ enum class ASTNodeType {
     BINARY_EXPRESSION
 };
 
-enum class BinaryOperator {
+enum class BinaryOperator : uint8_t {
     ADD,      // +
     SUBTRACT, // -
     MULTIPLY, // *
@@ -27,71 +31,115 @@ enum class BinaryOperator {
     MODULO    // %
 };
 
+// One fixed-size record for every node kind. The meaning of a, b and c
+// depends on the type; use the named accessors below rather than the raw
+// fields. Positions are kept in Program::positions, indexed like the nodes.
 struct ASTNode {
+    static constexpr uint8_t FIXED = 1; // declaration used 'fix'
+    
     ASTNodeType type;
-    Position position;
+    BinaryOperator op = BinaryOperator::ADD;
+    uint8_t flags = 0;
+    TypePair operand_types; // BINARY_EXPRESSION, filled in by the StaticAnalyzer
+    uint32_t a = 0;
+    uint32_t b = 0;
+    uint32_t c = 0;
     
-    ASTNode(ASTNodeType t, const Position& pos) : type(t), position(pos) {}
-    virtual ~ASTNode() = default;
-};
-
-struct Program : public ASTNode {
-    std::vector<ASTNodePtr> statements;
+    explicit ASTNode(ASTNodeType t) : type(t) {}
     
-    Program(const Position& pos) : ASTNode(ASTNodeType::PROGRAM, pos) {}
-};
-
-struct VariableDeclaration : public ASTNode {
-    std::string name;
-    ASTNodePtr value;
-    bool is_constant;
-    Position name_position;
+    static ASTNode literal(uint32_t constant);
+    static ASTNode identifier(uint32_t name);
+    static ASTNode binary(BinaryOperator op, NodeIndex left, NodeIndex right, uint32_t site);
+    static ASTNode declaration(NodeIndex target, NodeIndex value, bool is_constant);
+    static ASTNode assignment(NodeIndex target, NodeIndex value);
+    static ASTNode print(NodeIndex expression);
     
-    VariableDeclaration(const std::string& n, ASTNodePtr v, bool is_const, 
-                       const Position& pos, const Position& name_pos)
-        : ASTNode(ASTNodeType::VARIABLE_DECLARATION, pos), 
-          name(n), value(std::move(v)), is_constant(is_const), name_position(name_pos) {}
+    // LITERAL: index into Program::constants
+    uint32_t constant() const { return a; }
+    // IDENTIFIER: index into Program::names, and the slot the Resolver bound it to
+    uint32_t name() const { return a; }
+    uint32_t slot() const { return b; }
+    // BINARY_EXPRESSION, numbered for the engines' type feedback tables
+    NodeIndex left() const { return a; }
+    NodeIndex right() const { return b; }
+    uint32_t site() const { return c; }
+    // VARIABLE_DECLARATION / VARIABLE_ASSIGNMENT: the IDENTIFIER being
+    // written and the value expression (NO_NODE for a late-initialized var)
+    NodeIndex target() const { return a; }
+    NodeIndex value() const { return b; }
+    bool isConstant() const { return (flags & FIXED) != 0; }
+    // PRINT_STATEMENT
+    NodeIndex expression() const { return a; }
 };
 
-struct VariableAssignment : public ASTNode {
-    std::string name;
-    ASTNodePtr value;
-    Position name_position;
-    
-    VariableAssignment(const std::string& n, ASTNodePtr v, 
-                      const Position& pos, const Position& name_pos)
-        : ASTNode(ASTNodeType::VARIABLE_ASSIGNMENT, pos), 
-          name(n), value(std::move(v)), name_position(name_pos) {}
-};
+static_assert(sizeof(ASTNode) == 16, "ASTNode should stay 16 bytes");
 
-struct PrintStatement : public ASTNode {
-    ASTNodePtr expression;
-    
-    PrintStatement(ASTNodePtr expr, const Position& pos)
-        : ASTNode(ASTNodeType::PRINT_STATEMENT, pos), expression(std::move(expr)) {}
-};
+inline ASTNode ASTNode::literal(uint32_t constant) {
+    ASTNode node(ASTNodeType::LITERAL);
+    node.a = constant;
+    return node;
+}
 
-struct Literal : public ASTNode {
-    Token token;
-    
-    Literal(const Token& t) : ASTNode(ASTNodeType::LITERAL, t.position), token(t) {}
-};
+inline ASTNode ASTNode::identifier(uint32_t name) {
+    ASTNode node(ASTNodeType::IDENTIFIER);
+    node.a = name;
+    return node;
+}
 
-struct Identifier : public ASTNode {
-    std::string name;
-    
-    Identifier(const std::string& n, const Position& pos)
-        : ASTNode(ASTNodeType::IDENTIFIER, pos), name(n) {}
-};
+inline ASTNode ASTNode::binary(BinaryOperator op, NodeIndex left, NodeIndex right, uint32_t site) {
+    ASTNode node(ASTNodeType::BINARY_EXPRESSION);
+    node.op = op;
+    node.a = left;
+    node.b = right;
+    node.c = site;
+    return node;
+}
+
+inline ASTNode ASTNode::declaration(NodeIndex target, NodeIndex value, bool is_constant) {
+    ASTNode node(ASTNodeType::VARIABLE_DECLARATION);
+    node.a = target;
+    node.b = value;
+    node.flags = is_constant ? FIXED : 0;
+    return node;
+}
 
-struct BinaryExpression : public ASTNode {
-    ASTNodePtr left;
-    BinaryOperator operator_;
-    ASTNodePtr right;
+inline ASTNode ASTNode::assignment(NodeIndex target, NodeIndex value) {
+    ASTNode node(ASTNodeType::VARIABLE_ASSIGNMENT);
+    node.a = target;
+    node.b = value;
+    return node;
+}
+
+inline ASTNode ASTNode::print(NodeIndex expression) {
+    ASTNode node(ASTNodeType::PRINT_STATEMENT);
+    node.a = expression;
+    return node;
+}
+
+struct Program {
+    std::vector<ASTNode> nodes;
+    std::vector<Position> positions;
+    std::vector<NodeIndex> statements;
+    ConstantPool constants;
+    std::vector<std::string> names;      // interned identifier names
+    std::vector<std::string> slot_names; // filled in by the Resolver
+    uint32_t binary_sites = 0;           // BINARY_EXPRESSION nodes emitted
+    
+    NodeIndex add(const ASTNode& node, const Position& pos) {
+        nodes.push_back(node);
+        positions.push_back(pos);
+        return static_cast<NodeIndex>(nodes.size() - 1);
+    }
+    
+    // Drops every node from `first` on, e.g. a statement that failed to parse
+    void truncate(NodeIndex first) {
+        nodes.erase(nodes.begin() + first, nodes.end());
+        positions.erase(positions.begin() + first, positions.end());
+    }
     
-    BinaryExpression(ASTNodePtr l, BinaryOperator op, ASTNodePtr r, const Position& pos)
-        : ASTNode(ASTNodeType::BINARY_EXPRESSION, pos), 
-          left(std::move(l)), operator_(op), right(std::move(r)) {}
+    const ASTNode& operator[](NodeIndex index) const { return nodes[index]; }
+    ASTNode& operator[](NodeIndex index) { return nodes[index]; }
+    const Position& position(NodeIndex index) const { return positions[index]; }
 };
 
-} // namespace Lizard
\ No newline at end of file
+} // namespace Lizard
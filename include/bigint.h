@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Lizard {
+
+// Arbitrary-precision signed integer in sign-magnitude form, backing the
+// integer Values that do not fit in a NaN-boxed immediate. Division and
+// remainder truncate toward zero, matching the immediate fast paths.
+class BigInt {
+public:
+    BigInt() = default;
+    explicit BigInt(int64_t value);
+    
+    // `digits` must be a non-empty run of decimal digits
+    static BigInt parse(std::string_view digits);
+    // Truncates toward zero; `value` must be finite
+    static BigInt fromDouble(double value);
+    
+    bool isZero() const { return limbs.empty(); }
+    bool isNegative() const { return negative; }
+    bool fitsInt64() const;
+    int64_t toInt64() const; // only valid when fitsInt64()
+    double toDouble() const;
+    
+    void appendTo(std::string& out) const;
+    std::string toString() const;
+    
+    bool operator==(const BigInt& other) const {
+        return negative == other.negative && limbs == other.limbs;
+    }
+    
+    static BigInt add(const BigInt& left, const BigInt& right);
+    static BigInt subtract(const BigInt& left, const BigInt& right);
+    static BigInt multiply(const BigInt& left, const BigInt& right);
+    // `right` must be non-zero
+    static BigInt divide(const BigInt& left, const BigInt& right);
+    static BigInt remainder(const BigInt& left, const BigInt& right);
+    
+private:
+    using Limbs = std::vector<uint32_t>;
+    
+    Limbs limbs; // magnitude, least significant limb first, no leading zeros
+    bool negative = false;
+    
+    BigInt(Limbs magnitude, bool negative);
+    
+    static int compareMagnitude(const Limbs& left, const Limbs& right);
+    static Limbs addMagnitude(const Limbs& left, const Limbs& right);
+    static Limbs subtractMagnitude(const Limbs& left, const Limbs& right); // |left| >= |right|
+    static Limbs multiplyMagnitude(const Limbs& left, const Limbs& right);
+    static void divideMagnitude(const Limbs& left, const Limbs& right, Limbs& quotient, Limbs& rest);
+    static uint32_t divideSmall(Limbs& magnitude, uint32_t divisor);
+    static void multiplyAddSmall(Limbs& magnitude, uint32_t factor, uint32_t addend);
+    static void trim(Limbs& magnitude);
+};
+
+} // namespace Lizard
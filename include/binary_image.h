@@ -0,0 +1,91 @@
+#pragma once
+#include "value.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace Lizard {
+
+// Building blocks of the binary files the interpreter writes for itself
+// (.lzc caches and environment snapshots). Everything is in native byte
+// order; each format starts with a header that rejects foreign files.
+
+class ImageWriter {
+public:
+    void bytes(const void* data, size_t size) {
+        buffer.append(static_cast<const char*>(data), size);
+    }
+    template<typename T>
+    void scalar(T value) { bytes(&value, sizeof(value)); }
+    void text(const std::string& value) {
+        scalar(static_cast<uint32_t>(value.size()));
+        bytes(value.data(), value.size());
+    }
+    void value(const Value& value);
+
+    std::string_view data() const { return buffer; }
+
+    // Writes beside `path` and renames over it, so a concurrent reader
+    // never maps a half-written file. Returns false if nothing was written.
+    bool commit(const std::string& path) const;
+
+private:
+    std::string buffer;
+};
+
+// Every read is bounds-checked, so a truncated or corrupt file fails
+// cleanly instead of reading past the end
+class ImageReader {
+public:
+    ImageReader(const char* data, size_t size) : cursor(data), end(data + size) {}
+
+    bool bytes(void* out, size_t size) {
+        if (remaining() < size) {
+            return false;
+        }
+        std::memcpy(out, cursor, size);
+        cursor += size;
+        return true;
+    }
+    template<typename T>
+    bool scalar(T& out) { return bytes(&out, sizeof(out)); }
+    bool text(std::string& out) {
+        uint32_t size;
+        if (!scalar(size) || remaining() < size) {
+            return false;
+        }
+        out.assign(cursor, size);
+        cursor += size;
+        return true;
+    }
+    bool value(Value& out);
+
+    size_t remaining() const { return static_cast<size_t>(end - cursor); }
+    // Everything not read yet
+    std::string_view rest() const { return std::string_view(cursor, remaining()); }
+    bool atEnd() const { return cursor == end; }
+
+private:
+    const char* cursor;
+    const char* end;
+};
+
+// A read-only mapping of a whole regular file
+class MappedImage {
+public:
+    explicit MappedImage(const std::string& path);
+    ~MappedImage();
+    MappedImage(const MappedImage&) = delete;
+    MappedImage& operator=(const MappedImage&) = delete;
+
+    bool valid() const { return data != nullptr; }
+    ImageReader reader() const { return ImageReader(data, size); }
+
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+};
+
+} // namespace Lizard
@@ -0,0 +1,54 @@
+#pragma once
+#include "token.h"
+#include "value.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Lizard {
+
+enum class OpCode : uint8_t {
+    LOAD_CONST,   // R[a] = K[b]
+    GET_VAR,      // R[a] = slot b
+    DEFINE_VAR,   // define slot b = R[a], c = 1 if fixed
+    DECLARE_VAR,  // declare slot b uninitialized, c = 1 if fixed
+    SET_VAR,      // slot b = R[a]
+    ADD,          // R[a] = R[b] + R[c]
+    SUBTRACT,     // R[a] = R[b] - R[c]
+    MULTIPLY,     // R[a] = R[b] * R[c]
+    DIVIDE,       // R[a] = R[b] / R[c]
+    INT_DIV,      // R[a] = R[b] // R[c]
+    MODULO,       // R[a] = R[b] % R[c]
+    PRINT         // put R[a]
+};
+
+struct Instruction {
+    OpCode op;
+    TypePair types; // operand types of an arithmetic op, when known statically
+    uint16_t a;
+    uint32_t b;
+    uint32_t c;
+
+    Instruction(OpCode o, uint16_t a_ = 0, uint32_t b_ = 0, uint32_t c_ = 0)
+        : op(o), a(a_), b(b_), c(c_) {}
+};
+
+static_assert(sizeof(Instruction) == 12, "Instruction should stay 12 bytes");
+
+// A compiled program: flat instruction stream plus the pools it indexes.
+// positions[i] is the source position reported if code[i] raises an error;
+// names[slot] is the variable name used in diagnostics.
+struct Chunk {
+    std::vector<Instruction> code;
+    std::vector<Position> positions;
+    std::vector<Value> constants;
+    std::vector<std::string> names;
+    uint32_t register_count = 0;
+
+    void emit(const Instruction& instruction, const Position& pos) {
+        code.push_back(instruction);
+        positions.push_back(pos);
+    }
+};
+
+} // namespace Lizard
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+
+namespace Lizard {
+
+// Byte classes and run-scanning kernels for the lexer. The predicates are
+// plain ASCII tests, independent of the C locale. Each kernel returns the
+// first byte in [begin, end) that ends its run, or `end`; none of them
+// stops past a newline unless the run is a newline search. The kernels use
+// AVX2 or SSE2 when the CPU has them, chosen once at startup, and a scalar
+// loop otherwise.
+namespace CharScan {
+
+using Kernel = const char* (*)(const char* begin, const char* end);
+
+// First '\n'
+extern const Kernel findNewline;
+// First byte that is not a space, '\t', '\r', '\v' or '\f'
+extern const Kernel skipBlanks;
+// First byte that is not [A-Za-z0-9_]
+extern const Kernel skipIdentifier;
+// First '"', '\\' or '\n', the bytes that end a plain run in a string literal
+extern const Kernel findStringSpecial;
+
+// "avx2", "sse2" or "scalar"; reported under --profile
+const char* implementation();
+
+inline bool isDigit(char c) {
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+inline bool isAlpha(char c) {
+    return static_cast<unsigned char>((c | 0x20) - 'a') < 26;
+}
+
+inline bool isIdentifierStart(char c) {
+    return isAlpha(c) || c == '_';
+}
+
+inline bool isIdentifierChar(char c) {
+    return isAlpha(c) || isDigit(c) || c == '_';
+}
+
+// Whitespace other than '\n', which is a token of its own
+inline bool isBlank(char c) {
+    return c == ' ' || (static_cast<unsigned char>(c - '\t') < 5 && c != '\n');
+}
+
+} // namespace CharScan
+
+} // namespace Lizard
@@ -0,0 +1,30 @@
+#pragma once
+#include "ast.h"
+#include "bytecode.h"
+
+namespace Lizard {
+
+// Lowers a parsed Program into register bytecode for the VirtualMachine.
+class Compiler {
+public:
+    Chunk compile(const Program& program);
+
+private:
+    const Program* program = nullptr;
+    Chunk chunk;
+    uint16_t next_register = 0;
+
+    void compileStatement(NodeIndex index);
+    void compileVariableDeclaration(const ASTNode& node, const Position& pos);
+    void compileVariableAssignment(const ASTNode& node, const Position& pos);
+    void compilePrintStatement(const ASTNode& node, const Position& pos);
+
+    uint16_t compileExpression(NodeIndex index);
+    uint16_t compileLiteral(const ASTNode& node, const Position& pos);
+    uint16_t compileIdentifier(const ASTNode& node, const Position& pos);
+    uint16_t compileBinaryExpression(const ASTNode& node, const Position& pos);
+
+    uint16_t allocateRegister(const Position& pos);
+};
+
+} // namespace Lizard
@@ -0,0 +1,28 @@
+#pragma once
+#include "value.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Lizard {
+
+// Deduplicated table of the literal values a Program refers to. Equal
+// constants (same type and contents) share one index.
+class ConstantPool {
+public:
+    uint32_t add(const Value& value);
+
+    const Value& operator[](uint32_t index) const { return values[index]; }
+    size_t size() const { return values.size(); }
+    const std::vector<Value>& all() const { return values; }
+    void clear();
+
+private:
+    std::vector<Value> values;
+    std::unordered_map<uint64_t, uint32_t> scalar_indices;
+    std::unordered_map<std::string, uint32_t> string_indices;
+    std::unordered_map<std::string, uint32_t> bigint_indices; // keyed by decimal text
+};
+
+} // namespace Lizard
@@ -0,0 +1,38 @@
+#pragma once
+#include "ast.h"
+#include "source_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace Lizard {
+
+// Translates a resolved and analyzed Program into one C++ translation unit
+// that runs it against the CompiledProgram runtime. The original source is
+// embedded so runtime errors are formatted exactly as the interpreter
+// formats them.
+class CppEmitter {
+public:
+    // Statements per generated function
+    static constexpr size_t STATEMENTS_PER_PART = 256;
+
+    void emit(const Program& program, const SourceFile& source, std::ostream& out);
+
+private:
+    const Program* program = nullptr;
+    std::ostream* out = nullptr;
+    uint32_t next_temporary = 0;
+
+    void emitSource(const SourceFile& source);
+    void emitConstants();
+    void emitStatement(NodeIndex index);
+    // Declares temporaries for the operands that can fail and returns the
+    // C++ expression naming the value
+    std::string emitExpression(NodeIndex index);
+
+    static std::string quote(std::string_view text);
+    static std::string constant(const Value& value);
+};
+
+} // namespace Lizard
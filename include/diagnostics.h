@@ -0,0 +1,35 @@
+#pragma once
+#include "error_handler.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Lizard {
+
+// Collects recoverable errors from the lexer and parser so that a single
+// pass reports every problem instead of stopping at the first one. Once
+// `limit` errors have been recorded the front end stops early.
+class Diagnostics {
+public:
+    static constexpr size_t DEFAULT_LIMIT = 50;
+    
+    explicit Diagnostics(size_t limit = DEFAULT_LIMIT) : limit(limit) {}
+    
+    // An error at the same position as an earlier one is dropped, since it
+    // is almost always the parser tripping over what the lexer rejected
+    void report(const std::string& message, const Position& pos);
+    
+    bool hasErrors() const { return !errors.empty(); }
+    bool limitReached() const { return errors.size() >= limit; }
+    size_t errorCount() const { return errors.size(); }
+    
+    // Formats every collected error the same way main reports a LizardError,
+    // in source order
+    void print(std::ostream& out) const;
+    
+private:
+    size_t limit;
+    std::vector<LizardError> errors;
+};
+
+} // namespace Lizard
@@ -1,31 +1,55 @@
 #pragma once
 #include "value.h"
 #include "token.h"
-#include <unordered_map>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace Lizard {
 
 struct Variable {
     Value value;
-    bool is_constant;
-    bool is_initialized;
+    bool is_defined = false;
+    bool is_constant = false;
+    bool is_initialized = false;
     Position declaration_position;
-    
-    Variable(const Value& v, bool is_const, bool init, const Position& pos)
-        : value(v), is_constant(is_const), is_initialized(init), declaration_position(pos) {}
 };
 
+// Variables live in a flat array indexed by the slots the Resolver assigned.
+// Every slot exists up front; the flags record what has happened to it so far.
 class Environment {
 public:
-    void define(const std::string& name, const Value& value, bool is_constant, const Position& pos);
-    void assign(const std::string& name, const Value& value, const Position& assign_pos);
-    Value get(const std::string& name, const Position& access_pos);
-    bool exists(const std::string& name) const;
-    Variable* getVariable(const std::string& name);
+    // A prelude, e.g. from a Snapshot, fills the first slots; the Resolver
+    // gave its names those slots
+    void reset(const std::vector<std::string>& slot_names,
+               const std::vector<Variable>* prelude = nullptr);
+    // Adds slots for names appended since the last reset() or grow()
+    void grow(const std::vector<std::string>& slot_names) {
+        names = &slot_names;
+        variables.resize(slot_names.size());
+    }
+
+    void define(uint32_t slot, const Value& value, bool is_constant, bool is_initialized,
+                const Position& pos);
+    void assign(uint32_t slot, const Value& value, const Position& assign_pos);
+
+    // The slots themselves, for generated code that checks the flags inline
+    Variable* data() { return variables.data(); }
+    const std::vector<Variable>& slots() const { return variables; }
+
+    const Value& get(uint32_t slot, const Position& access_pos) const {
+        const Variable& var = variables[slot];
+        if (!var.is_initialized) {
+            reportInvalidAccess(slot, access_pos);
+        }
+        return var.value;
+    }
 
 private:
-    std::unordered_map<std::string, Variable> variables;
+    std::vector<Variable> variables;
+    const std::vector<std::string>* names = nullptr;
+
+    [[noreturn]] void reportInvalidAccess(uint32_t slot, const Position& access_pos) const;
 };
 
-} // namespace Lizard
\ No newline at end of file
+} // namespace Lizard
@@ -4,23 +4,18 @@
 
 namespace Lizard {
 
+// Binary arithmetic shared by both engines. evaluate() dispatches through a
+// table of kernels indexed by [operator][left type][right type] that is
+// generated at compile time from the type traits in eval_arithmetic.cpp.
 class ArithmeticEvaluator {
 public:
-    static Value evaluateBinaryExpression(const BinaryExpression& node, 
-                                        const Value& left, const Value& right);
-    
-private:
-    static Value add(const Value& left, const Value& right, const Position& pos);
-    static Value subtract(const Value& left, const Value& right, const Position& pos);
-    static Value multiply(const Value& left, const Value& right, const Position& pos);
-    static Value divide(const Value& left, const Value& right, const Position& pos);
-    static Value integerDivide(const Value& left, const Value& right, const Position& pos);
-    static Value modulo(const Value& left, const Value& right, const Position& pos);
-    
-    static bool isNumeric(const Value& value);
-    static double toDouble(const Value& value);
-    static int toInt(const Value& value);
-    static std::string getTypeName(const Value& value);
+    static Value evaluate(BinaryOperator op, const Value& left, const Value& right,
+                          const Position& pos);
+    // Skips the type lookup; `types` must be the operands' actual types
+    static Value evaluate(BinaryOperator op, TypePair types, const Value& left, const Value& right,
+                          const Position& pos);
+    // True when evaluate() would produce a result instead of raising an error
+    static bool canEvaluate(BinaryOperator op, const Value& left, const Value& right);
 };
 
-} // namespace Lizard
\ No newline at end of file
+} // namespace Lizard
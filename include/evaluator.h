@@ -2,28 +2,45 @@
 #include "ast.h"
 #include "value.h"
 #include "environment.h"
+#include "output_buffer.h"
+#include "type_feedback.h"
+#include <ostream>
+#include <vector>
 
 namespace Lizard {
 
 class Evaluator {
 private:
     Environment environment;
+    OutputBuffer& output;
+    const Program* program = nullptr;
+    std::vector<BinarySite> sites; // indexed by ASTNode::site()
+    const std::vector<Variable>* prelude = nullptr;
     
 public:
-    Evaluator();
+    explicit Evaluator(OutputBuffer& output);
+    
+    // Variables the program starts with, in its first slots
+    void setPrelude(const std::vector<Variable>& variables) { prelude = &variables; }
+    // The variables as the last evaluate() left them
+    const Environment& globals() const { return environment; }
     
     void evaluate(const Program& program);
+    // Streaming: runs one statement of a Program that is refilled between
+    // calls. Variables carry over; slots the Resolver added are created.
+    void execute(const Program& program, NodeIndex statement);
+    void printProfile(std::ostream& out) const { TypeFeedback::printReport(out, sites); }
     
 private:
-    void executeStatement(const ASTNode& node);
-    void executeVariableDeclaration(const VariableDeclaration& node);
-    void executeVariableAssignment(const VariableAssignment& node);
-    void executePrintStatement(const PrintStatement& node);
+    void executeStatement(NodeIndex index);
+    void executeVariableDeclaration(const ASTNode& node, const Position& pos);
+    void executeVariableAssignment(const ASTNode& node, const Position& pos);
+    void executePrintStatement(const ASTNode& node);
     
-    Value evaluateExpression(const ASTNode& node);
-    Value evaluateLiteral(const Literal& node);
-    Value evaluateIdentifier(const Identifier& node);
-    Value evaluateBinaryExpression(const BinaryExpression& node);
+    Value evaluateExpression(NodeIndex index);
+    Value evaluateLiteral(const ASTNode& node);
+    Value evaluateIdentifier(const ASTNode& node, const Position& pos);
+    Value evaluateBinaryExpression(const ASTNode& node, const Position& pos);
 };
 
-} // namespace Lizard
\ No newline at end of file
+} // namespace Lizard
@@ -0,0 +1,98 @@
+#pragma once
+#include "ast.h"
+#include "constant_pool.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Lizard {
+
+// Mid-level IR in SSA form. Lizard has no control flow, so a function is a
+// list of straight-line basic blocks and no phi nodes are needed. Every
+// instruction lives in IRFunction::values and is named by its index there;
+// instructions that produce a value are referred to by that same index.
+using IRValue = uint32_t;
+constexpr IRValue NO_VALUE = UINT32_MAX;
+
+enum class IROp : uint8_t {
+    CONST,    // %n = constant `operand`
+    LOAD,     // %n = variable slot `operand`
+    DEFINE,   // define slot `operand` = a (fixed if `fixed`)
+    DECLARE,  // declare slot `operand` uninitialized (fixed if `fixed`)
+    STORE,    // slot `operand` = a
+    BINARY,   // %n = a `binary_op` b
+    PRINT     // put a
+};
+
+struct IRInstruction {
+    IROp op;
+    BinaryOperator binary_op = BinaryOperator::ADD;
+    bool fixed = false;
+    TypePair types;          // BINARY: operand types proven before lowering
+    uint32_t operand = 0;    // constant index or variable slot
+    IRValue a = NO_VALUE;
+    IRValue b = NO_VALUE;
+    Position position;
+    
+    explicit IRInstruction(IROp op) : op(op) {}
+    
+    bool producesValue() const {
+        return op == IROp::CONST || op == IROp::LOAD || op == IROp::BINARY;
+    }
+    bool readsSlot() const { return op == IROp::LOAD; }
+    bool writesSlot() const {
+        return op == IROp::DEFINE || op == IROp::DECLARE || op == IROp::STORE;
+    }
+};
+
+struct IRBlock {
+    std::string name;
+    std::vector<IRValue> instructions; // in execution order
+};
+
+struct IRFunction {
+    std::vector<IRInstruction> values;
+    std::vector<IRBlock> blocks;
+    ConstantPool* constants = nullptr;
+    const std::vector<std::string>* slot_names = nullptr;
+    
+    IRValue append(IRBlock& block, const IRInstruction& instruction) {
+        values.push_back(instruction);
+        IRValue value = static_cast<IRValue>(values.size() - 1);
+        block.instructions.push_back(value);
+        return value;
+    }
+    
+    size_t instructionCount() const;
+    void print(std::ostream& out) const;
+};
+
+// Static type of an IR value: a ValueType + 1, or UNKNOWN_TYPE
+using IRType = uint8_t;
+constexpr IRType UNKNOWN_TYPE = 0;
+
+inline IRType irType(ValueType type) { return static_cast<IRType>(static_cast<unsigned>(type) + 1); }
+inline ValueType valueType(IRType type) { return static_cast<ValueType>(type - 1); }
+
+// Types every value is guaranteed to have if the instruction producing it
+// completes. Constants are exact; loads are unknown unless an operand
+// annotation proves otherwise.
+std::vector<IRType> inferTypes(const IRFunction& function);
+
+// Lowers a resolved Program into a single-block IRFunction. The function
+// borrows the Program's constant pool and slot names.
+class IRBuilder {
+public:
+    IRFunction build(Program& program);
+
+private:
+    Program* program = nullptr;
+    IRFunction function;
+
+    void lowerStatement(NodeIndex index);
+    IRValue lowerExpression(NodeIndex index);
+    IRValue emit(IRInstruction instruction, const Position& pos);
+};
+
+} // namespace Lizard
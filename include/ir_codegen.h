@@ -0,0 +1,17 @@
+#pragma once
+#include "ir.h"
+#include "bytecode.h"
+
+namespace Lizard {
+
+// Emits VM bytecode for an IRFunction. SSA values are assigned registers
+// by their live ranges, so a value forwarded across statements keeps its
+// register until its last use.
+class IRCodegen {
+public:
+    // Returns false if more values are live at once than an instruction
+    // can address
+    bool generate(const IRFunction& function, Chunk& chunk);
+};
+
+} // namespace Lizard
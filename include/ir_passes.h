@@ -0,0 +1,75 @@
+#pragma once
+#include "ir.h"
+#include <memory>
+#include <ostream>
+#include <vector>
+
+namespace Lizard {
+
+// A transformation over an IRFunction. Passes only remove or merge
+// instructions that are proven not to raise an error, and never reorder
+// the rest, so runtime errors keep their position and output ordering.
+class IRPass {
+public:
+    virtual ~IRPass() = default;
+    virtual const char* name() const = 0;
+    // Returns true if the function changed
+    virtual bool run(IRFunction& function) = 0;
+};
+
+// Forwards the value of the last definition or store of a slot to the
+// loads that follow it, which then disappear.
+class CopyPropagation : public IRPass {
+public:
+    const char* name() const override { return "copy-prop"; }
+    bool run(IRFunction& function) override;
+};
+
+// Removes repeated loads of a slot with no write in between and repeated
+// binary operations on the same operand values.
+class CommonSubexpressionElimination : public IRPass {
+public:
+    const char* name() const override { return "cse"; }
+    bool run(IRFunction& function) override;
+};
+
+// Numbers constants by pool index and binary operations by operator and
+// operand numbers, folding operations on constants and matching commuted
+// numeric operands; a value already computed is reused.
+class GlobalValueNumbering : public IRPass {
+public:
+    const char* name() const override { return "gvn"; }
+    bool run(IRFunction& function) override;
+};
+
+// Drops `var` values that are overwritten before any load of the slot. A
+// dead store is removed; a dead definition becomes a declaration so
+// redefinition is still reported.
+class DeadStoreElimination : public IRPass {
+public:
+    const char* name() const override { return "dse"; }
+    bool run(IRFunction& function) override;
+};
+
+// Removes unused values whose computation cannot raise an error.
+class DeadCodeElimination : public IRPass {
+public:
+    const char* name() const override { return "dce"; }
+    bool run(IRFunction& function) override;
+};
+
+class PassManager {
+public:
+    // The pipeline for an -O level; level 0 runs no passes
+    static PassManager forLevel(int level);
+    
+    void add(std::unique_ptr<IRPass> pass) { passes.push_back(std::move(pass)); }
+    // Runs every pass in order. With `dump`, the IR is printed after
+    // lowering and after each pass.
+    void run(IRFunction& function, std::ostream* dump = nullptr);
+    
+private:
+    std::vector<std::unique_ptr<IRPass>> passes;
+};
+
+} // namespace Lizard
@@ -0,0 +1,70 @@
+#pragma once
+#include "bytecode.h"
+#include "environment.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Lizard {
+
+class JitCompiler;
+
+// Native x86-64 code for the arithmetic runs of a Chunk.
+//
+// A region is a maximal run of LOAD_CONST (immediates only), GET_VAR,
+// SET_VAR and arithmetic instructions. Programs have no loops, so every
+// instruction runs once and hotness is judged by region length: runs
+// shorter than MIN_REGION stay interpreted. Regions are compiled in
+// batches just ahead of execution into one reused executable mapping, so
+// native code never needs more memory than a batch.
+//
+// Generated code works on the NaN-boxed bits directly. Variables are
+// assumed to keep the type they hold when their batch is compiled, and
+// every assumption is guarded: operand tags, 48-bit overflow, zero
+// divisors, heap values and variable state. A failed guard returns the pc
+// of the instruction it guards, and the interpreter resumes there,
+// raising any error itself.
+class Jit {
+public:
+    static constexpr size_t MIN_REGION = 8;
+    static constexpr size_t NO_REGION = SIZE_MAX;
+
+    // Finds the regions of `chunk`; nothing is compiled yet. On hosts other
+    // than x86-64 Linux there are no regions.
+    explicit Jit(const Chunk& chunk);
+    ~Jit();
+    Jit(const Jit&) = delete;
+    Jit& operator=(const Jit&) = delete;
+
+    // First pc at or after `pc` where a region starts, or NO_REGION
+    size_t nextRegion(size_t pc);
+    // Runs the region starting at `pc`; returns the pc to continue
+    // interpreting at. Regions must be run in increasing pc order.
+    size_t run(size_t pc, Value* registers, Variable* variables);
+
+    size_t regionCount() const { return regions.size(); }
+    size_t compiledBytes() const { return compiled_bytes; }
+
+private:
+    using Entry = uint32_t (*)(Value* registers, Variable* variables);
+
+    struct Region {
+        uint32_t start;
+        uint32_t end;
+        Entry entry = nullptr; // set while the region is in the current batch
+    };
+
+    const Chunk& chunk;
+    std::unique_ptr<JitCompiler> compiler;
+    std::vector<Region> regions;
+    size_t cursor = 0;          // first region not yet run
+    size_t batch_end = 0;       // regions [cursor, batch_end) are compiled
+    void* memory = nullptr;
+    size_t mapped_size = 0;
+    size_t compiled_bytes = 0;
+
+    void compileBatch(const Variable* variables);
+};
+
+} // namespace Lizard
@@ -1,19 +1,32 @@
 #pragma once
 #include "token.h"
 #include "lexer_state.h"
-#include <string>
-#include <vector>
+#include <string_view>
 
 namespace Lizard {
 
 class Lexer {
 public:
-    Lexer(const std::string& source, const std::string& filename);
+    Lexer(std::string_view source, uint32_t file, Diagnostics& diagnostics);
+    // Reads the source in chunks as tokens are requested
+    Lexer(SourceStream& stream, uint32_t file, Diagnostics& diagnostics);
     
-    std::vector<Token> tokenize();
+    TokenList tokenize();
+    
+    // The next token, or EOF_TOKEN once the input is exhausted. Offsets
+    // are into source(); decoded strings point into decoded().
+    Token next();
+    
+    uint32_t file() const { return state.getFile(); }
+    std::string_view source() const { return state.getSource(); }
+    const std::string& decoded() const { return state.decoded; }
+    // Bytes of source() already turned into tokens
+    size_t consumed() const { return state.getOffset(); }
+    // Streaming only; see LexerState::discard
+    void discard(size_t count) { state.discard(count); }
     
 private:
     LexerState state;
 };
 
-} // namespace Lizard
\ No newline at end of file
+} // namespace Lizard
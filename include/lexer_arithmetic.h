@@ -1,9 +0,0 @@
-#pragma once
-#include "token.h"
-#include "lexer_state.h"
-
-namespace Lizard {
-
-Token parseArithmeticOperator(LexerState& state);
-
-} // namespace Lizard
\ No newline at end of file
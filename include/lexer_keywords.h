@@ -1,13 +1,13 @@
 #pragma once
 #include "token.h"
-#include <string>
+#include <string_view>
 
 namespace Lizard {
 
 // Returns the token type for a keyword, or IDENTIFIER if not a keyword
-TokenType getKeywordType(const std::string& identifier);
+TokenType getKeywordType(std::string_view identifier);
 
 // Checks if an identifier is a keyword
-bool isKeyword(const std::string& identifier);
+bool isKeyword(std::string_view identifier);
 
-} // namespace Lizard
\ No newline at end of file
+} // namespace Lizard
@@ -0,0 +1,12 @@
+#pragma once
+#include "token.h"
+#include "lexer_state.h"
+
+namespace Lizard {
+
+// Consumes the longest operator in LexerTable::operators that starts at
+// the current position and returns its type, or EOF_TOKEN, consuming
+// nothing, if none does
+TokenType parseOperator(LexerState& state);
+
+} // namespace Lizard
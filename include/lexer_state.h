@@ -1,31 +1,89 @@
 #pragma once
 #include "token.h"
+#include "diagnostics.h"
+#include "source_stream.h"
+#include "char_scan.h"
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 
 namespace Lizard {
 
-// Shared state for lexer operations
+// Shared state for lexer operations. The source is borrowed, not copied; it
+// must outlive the LexerState and the tokens produced from it.
+//
+// Over a SourceStream the source is whatever the stream has buffered, and
+// reaching its end reads the next chunk. Offsets stay valid until
+// discard() drops the text behind them.
 class LexerState {
 public:
-    LexerState(const std::string& source, const std::string& filename);
+    // Where a token started
+    struct Mark {
+        uint32_t offset;
+        uint32_t line;
+        uint32_t column;
+    };
     
-    bool isAtEnd() const;
+    LexerState(std::string_view source, uint32_t file, Diagnostics& diagnostics);
+    LexerState(SourceStream& stream, uint32_t file, Diagnostics& diagnostics);
+    
+    bool isAtEnd() { return current >= source.length() && !refill(); }
     char advance();
-    char peek() const;
-    char peekNext(int offset = 1) const;
+    char peek();
+    char peekNext(int offset = 1);
     bool match(char expected);
     
+    // Streaming only: forgets the first `count` bytes of the buffered
+    // source, which must all have been consumed, and the decoded buffer
+    void discard(size_t count);
+    
     void skipWhitespace();
     void skipComment();
+    // Consumes the run `scan` finds, which must not contain a newline
+    void skipRun(CharScan::Kernel scan);
     
     Position getCurrentPosition() const;
+    Position positionOf(const Mark& mark) const;
+    Mark mark() const;
+    
+    // Token covering everything consumed since `start`
+    Token tokenFrom(const Mark& start, TokenType type);
+    
+    // Records a lexical error; lexing continues afterwards
+    void error(const std::string& message, const Position& pos) { diagnostics.report(message, pos); }
+    bool shouldStop() const { return diagnostics.limitReached(); }
+    
+    uint32_t getFile() const { return file; }
+    size_t getOffset() const { return current; }
+    std::string_view getSource() const { return source; }
+    
+    // Side buffer of length-prefixed records: string literals whose escapes
+    // had to be rewritten, and text too long for Token::length
+    std::string decoded;
+    
+    // Starts a record in `decoded` whose text is appended next
+    size_t beginDecoded();
+    // Called with the start of a record once its text is complete. If an
+    // identical record was decoded before, the new copy is dropped and the
+    // earlier offset returned; otherwise `start` is.
+    uint32_t internDecoded(size_t start);
+    // A whole record holding `text`
+    uint32_t copyDecoded(std::string_view text);
     
 private:
-    std::string source;
-    std::string filename;
+    std::string_view source;
+    SourceStream* stream = nullptr;
+    uint32_t file;
+    Diagnostics& diagnostics;
     size_t current;
     int line;
     int column;
+    // Decoded records by content hash, as (offset, size) in `decoded`
+    std::unordered_multimap<size_t, std::pair<uint32_t, uint32_t>> interned;
+    
+    // Reads more of the stream; false when there is nothing left
+    bool refill();
 };
 
-} // namespace Lizard
\ No newline at end of file
+} // namespace Lizard
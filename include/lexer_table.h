@@ -0,0 +1,117 @@
+#pragma once
+#include "token.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Lizard {
+
+// The lexer's dispatch tables, all built at compile time. A new operator
+// is one more line in `operators`; the character classes and the
+// operator DFA are derived from it.
+namespace LexerTable {
+
+struct Spelling {
+    std::string_view text;
+    TokenType type;
+};
+
+inline constexpr Spelling operators[] = {
+    {"=", TokenType::ASSIGN},
+    {"+", TokenType::PLUS},
+    {"-", TokenType::MINUS},
+    {"*", TokenType::STARS},
+    {"/", TokenType::SLASH},
+    {"%", TokenType::PERCENT},
+    {"//", TokenType::INT_DIVISION},
+    {"(", TokenType::LEFT_PAREN},
+    {")", TokenType::RIGHT_PAREN},
+};
+
+// What a token starting with a given byte is; Lexer::next switches on it
+enum class CharClass : uint8_t {
+    INVALID,
+    BLANK,
+    NEWLINE,
+    COMMENT,
+    QUOTE,
+    DIGIT,
+    IDENTIFIER,
+    OPERATOR
+};
+
+constexpr std::array<CharClass, 256> buildCharClasses() {
+    std::array<CharClass, 256> classes{};
+    for (unsigned c : {' ', '\t', '\r', '\v', '\f'}) {
+        classes[c] = CharClass::BLANK;
+    }
+    classes['\n'] = CharClass::NEWLINE;
+    classes['#'] = CharClass::COMMENT;
+    classes['"'] = CharClass::QUOTE;
+    for (unsigned c = '0'; c <= '9'; ++c) {
+        classes[c] = CharClass::DIGIT;
+    }
+    for (unsigned c = 'a'; c <= 'z'; ++c) {
+        classes[c] = CharClass::IDENTIFIER;
+        classes[c - 'a' + 'A'] = CharClass::IDENTIFIER;
+    }
+    classes['_'] = CharClass::IDENTIFIER;
+    for (const Spelling& op : operators) {
+        classes[static_cast<unsigned char>(op.text[0])] = CharClass::OPERATOR;
+    }
+    return classes;
+}
+
+inline constexpr std::array<CharClass, 256> char_classes = buildCharClasses();
+
+inline CharClass classOf(char c) {
+    return char_classes[static_cast<unsigned char>(c)];
+}
+
+// Trie of the operator spellings as a DFA over bytes. State 0 is the start
+// and doubles as the dead state, since no transition leads back to it.
+constexpr size_t operatorStateCount() {
+    size_t count = 1;
+    for (const Spelling& op : operators) {
+        count += op.text.size();
+    }
+    return count;
+}
+
+struct OperatorDfa {
+    static constexpr size_t MAX_STATES = operatorStateCount();
+    static_assert(MAX_STATES <= 256, "operator states must fit in a byte");
+
+    std::array<std::array<uint8_t, 256>, MAX_STATES> next{};
+    // Token for the operator spelled by the path to each state, or
+    // EOF_TOKEN if that path is only a prefix
+    std::array<TokenType, MAX_STATES> accept{};
+};
+
+constexpr OperatorDfa buildOperatorDfa() {
+    OperatorDfa dfa;
+    for (TokenType& type : dfa.accept) {
+        type = TokenType::EOF_TOKEN;
+    }
+
+    size_t states = 1;
+    for (const Spelling& op : operators) {
+        size_t state = 0;
+        for (char c : op.text) {
+            uint8_t& target = dfa.next[state][static_cast<unsigned char>(c)];
+            if (target == 0) {
+                target = static_cast<uint8_t>(states++);
+            }
+            state = target;
+        }
+        dfa.accept[state] = op.type;
+    }
+    return dfa;
+}
+
+inline constexpr OperatorDfa operator_dfa = buildOperatorDfa();
+
+} // namespace LexerTable
+
+} // namespace Lizard
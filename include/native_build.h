@@ -0,0 +1,16 @@
+#pragma once
+#include <string>
+
+namespace Lizard {
+
+// Turns C++ from CppEmitter into an executable with the local C++ compiler,
+// linked against the runtime library installed alongside lizard, or the one
+// in its build tree when it has not been installed. The compiler is $CXX
+// when set, otherwise the one lizard itself was built with.
+class NativeBuild {
+public:
+    // Returns false after printing why to std::cerr
+    static bool build(const std::string& cpp_source, const std::string& output_path);
+};
+
+} // namespace Lizard
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace Lizard {
+
+// Conversions between numbers and their source/output text. Floats are
+// written in the shortest form that reads back as the same double, so
+// printing and reparsing a value never changes it.
+namespace NumberFormat {
+
+// Room needed by formatInt and formatFloat
+constexpr size_t MAX_CHARS = 32;
+
+// Write the text to `out` and return one past its last character
+char* formatInt(char* out, int64_t value);
+char* formatFloat(char* out, double value);
+
+void appendInt(std::string& out, int64_t value);
+void appendFloat(std::string& out, double value);
+
+enum class ParseStatus {
+    OK,
+    OUT_OF_RANGE,
+    INVALID
+};
+
+// The whole of `text` must be the number
+ParseStatus parseInt(std::string_view text, int64_t& value);
+ParseStatus parseFloat(std::string_view text, double& value);
+
+} // namespace NumberFormat
+
+} // namespace Lizard
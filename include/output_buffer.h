@@ -0,0 +1,70 @@
+#pragma once
+#include "value.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+namespace Lizard {
+
+// Collects program output in a user-space buffer and hands it to the kernel
+// in large write(2) calls. The buffer is flushed when it fills, on flush(),
+// on destruction, and by a line written FLUSH_INTERVAL or more after the
+// previous flush. Callers flush before errors and, when streaming, after
+// each statement. Line buffering flushes after every line instead.
+class OutputBuffer {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 64 * 1024;
+    static constexpr std::chrono::milliseconds FLUSH_INTERVAL{100};
+    // The clock is read on every line while lines are slow and on up to
+    // every MAX_CLOCK_STRIDE-th line while they come in a burst
+    static constexpr uint32_t MAX_CLOCK_STRIDE = 64;
+    
+    explicit OutputBuffer(int fd, size_t capacity = DEFAULT_CAPACITY);
+    ~OutputBuffer();
+    
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+    
+    void setLineBuffered(bool enabled) { line_buffered = enabled; }
+    
+    // Writes the value and a newline, then applies the flush policy
+    void writeLine(const Value& value);
+    
+    void flush();
+    
+private:
+    int fd;
+    size_t capacity;
+    size_t length = 0;
+    std::unique_ptr<char[]> data;
+    bool line_buffered = false;
+    bool failed = false;
+    
+    std::chrono::steady_clock::time_point last_flush;
+    std::chrono::steady_clock::time_point last_check;
+    uint32_t clock_stride = 1;
+    uint32_t lines_until_check = 1;
+    
+    void write(std::string_view text);
+    void write(char c) {
+        if (length == capacity) {
+            flush();
+        }
+        data[length++] = c;
+    }
+    
+    // Formats the value straight into the buffer, like Value::toString()
+    void writeValue(const Value& value);
+    
+    // Flushes if FLUSH_INTERVAL has passed and picks when to look again
+    void checkClock();
+    // A clock with a resolution of a few milliseconds, plenty next to
+    // FLUSH_INTERVAL, that costs a fraction of steady_clock::now()
+    static std::chrono::steady_clock::time_point coarseNow();
+    
+    void writeAll(const char* bytes, size_t count);
+};
+
+} // namespace Lizard
@@ -2,8 +2,13 @@
 #include "ast.h"
 #include "token.h"
 #include "parser_arithmetic.h"
-#include <vector>
+#include "diagnostics.h"
+#include "lexer.h"
+#include <deque>
 #include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 namespace Lizard {
 
@@ -11,36 +16,65 @@ class Parser {
     friend class ArithmeticParser;
     
 private:
-    std::vector<Token> tokens;
+    TokenList stream_tokens; // streaming only: the current statement and lookahead
+    const TokenList& token_list;
+    const std::vector<Token>& tokens;
+    Lexer* lexer = nullptr;
+    Diagnostics& diagnostics;
     size_t current;
+    std::unique_ptr<Program> program;
+    std::unordered_map<std::string_view, uint32_t> name_ids;
+    std::deque<std::string> owned_names; // streaming only: keys of name_ids
     ArithmeticParser arithmetic_parser;
     
 public:
-    Parser(const std::vector<Token>& tokens);
+    // The TokenList is borrowed and must outlive the Parser. Syntax errors
+    // are recorded in `diagnostics`; statements that fail to parse are
+    // skipped and parsing resumes at the next statement.
+    Parser(const TokenList& tokens, Diagnostics& diagnostics);
+    // Streaming: pulls tokens from the lexer as statements need them
+    Parser(Lexer& lexer, Diagnostics& diagnostics);
     
     std::unique_ptr<Program> parse();
     
+    // Streaming: parses the next statement into streamingProgram(), which
+    // only ever holds that one statement plus the names seen so far. The
+    // previous statement's nodes, constants and tokens are freed first.
+    // Returns NO_NODE at the end of input or after a syntax error.
+    NodeIndex parseNext();
+    Program& streamingProgram() { return *program; }
+    
     // Token navigation methods (made public for ArithmeticParser)
     bool isAtEnd() const;
-    Token peek() const;
-    Token previous() const;
-    Token advance();
+    const Token& peek() const;
+    const Token& previous() const;
+    const Token& advance();
     bool check(TokenType type) const;
     bool match(TokenType type);
-    void consume(TokenType type, const std::string& message);
+    bool consume(TokenType type, const std::string& message);
+    void error(const std::string& message, const Position& pos) { diagnostics.report(message, pos); }
+    
+    std::string_view text(const Token& token) const { return token_list.text(token); }
+    Position position(const Token& token) const { return token_list.position(token); }
+    
+    // Appends a node to the program being built
+    NodeIndex emit(const ASTNode& node, const Position& pos) { return program->add(node, pos); }
+    uint32_t internName(std::string_view name);
     
 private:
     void synchronize();
+    void pullToken();
+    void releaseStatement();
     
-    // Statement parsing
-    ASTNodePtr statement();
-    ASTNodePtr variableDeclaration();
-    ASTNodePtr variableAssignment();
-    ASTNodePtr printStatement();
+    // Statement parsing; each returns NO_NODE after reporting an error
+    NodeIndex statement();
+    NodeIndex variableDeclaration();
+    NodeIndex variableAssignment();
+    NodeIndex printStatement();
     
     // Expression parsing (now delegated to ArithmeticParser)
-    ASTNodePtr expression();
-    ASTNodePtr primary();
+    NodeIndex expression();
+    NodeIndex primary();
 };
 
 } // namespace Lizard
\ No newline at end of file
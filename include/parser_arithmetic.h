@@ -1,6 +1,7 @@
 #pragma once
 #include "ast.h"
 #include "token.h"
+#include "parser_fold.h"
 #include <vector>
 
 namespace Lizard {
@@ -10,17 +11,21 @@ class Parser; // Forward declaration
 class ArithmeticParser {
 private:
     Parser* parser;
+    ConstantFolder folder;
     
 public:
-    ArithmeticParser(Parser* p) : parser(p) {}
+    ArithmeticParser(Parser* p);
     
-    ASTNodePtr parseExpression();
-    ASTNodePtr parseAddition();
-    ASTNodePtr parseMultiplication();
-    ASTNodePtr parseUnary();
-    ASTNodePtr parsePrimary();
+    NodeIndex parseExpression();
+    NodeIndex parseAddition();
+    NodeIndex parseMultiplication();
+    NodeIndex parseUnary();
+    NodeIndex parsePrimary();
     
     BinaryOperator tokenToBinaryOperator(TokenType type);
+    
+private:
+    Value decodeLiteral(const Token& token);
 };
 
 } // namespace Lizard
\ No newline at end of file
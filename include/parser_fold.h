@@ -0,0 +1,39 @@
+#pragma once
+#include "ast.h"
+
+namespace Lizard {
+
+// Parse-time simplification of binary expressions. Literal-only operands are
+// evaluated with ArithmeticEvaluator semantics and replaced by a Literal for
+// the result; identities such as `x * 1` are dropped when the operand's type
+// makes them exact. Operands are the most recently emitted nodes of
+// `program`, so literals that get folded away are trimmed off its tail.
+// Anything that would raise an error is left for the runtime so the
+// diagnostic keeps its original position.
+class ConstantFolder {
+public:
+    explicit ConstantFolder(Program& program) : program(program) {}
+    
+    NodeIndex foldBinary(NodeIndex left, BinaryOperator op, NodeIndex right,
+                         const Position& pos);
+    
+private:
+    // What the parser can prove about an expression's result type
+    enum class StaticType {
+        UNKNOWN,
+        NUMBER,   // integer or float
+        INTEGER,
+        FLOAT,
+        OTHER     // string, boolean or nil
+    };
+    
+    Program& program;
+    
+    const Value* constantValue(NodeIndex node) const;
+    bool isIntegerConstant(NodeIndex node, int expected) const;
+    StaticType staticTypeOf(NodeIndex node) const;
+    bool isLastNode(NodeIndex node) const { return node + 1 == program.nodes.size(); }
+    static bool isNumber(StaticType type);
+};
+
+} // namespace Lizard
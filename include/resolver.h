@@ -0,0 +1,32 @@
+#pragma once
+#include "ast.h"
+#include <string>
+#include <vector>
+
+namespace Lizard {
+
+// Binds every variable name in a Program to a numeric slot so that the
+// engines can keep variables in a flat array instead of a name map.
+// Slots are handed out in order of first appearance, after any
+// predefined names (a snapshot's variables), which keep their order;
+// whether a slot is defined, fixed or initialized is tracked by the
+// Environment at runtime.
+class Resolver {
+public:
+    void resolve(Program& program, const std::vector<std::string>* predefined = nullptr);
+    // Streaming: binds one more statement of a Program whose names only
+    // grow, keeping the slots handed out so far
+    void resolveNext(Program& program, NodeIndex statement);
+
+private:
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+    Program* program = nullptr;
+    std::vector<uint32_t> slots; // indexed by interned name
+
+    void resolveStatement(NodeIndex index);
+    void resolveExpression(NodeIndex index);
+    void bindIdentifier(NodeIndex index);
+};
+
+} // namespace Lizard
@@ -0,0 +1,32 @@
+#pragma once
+#include "ast.h"
+#include "source_file.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace Lizard {
+
+// On-disk cache of resolved and analyzed Programs (.lzc files), so a warm
+// start skips lexing, parsing, resolution and analysis. An entry records
+// the hash and size of the source it was built from and the interpreter
+// version that wrote it, plus a hash of its own contents; anything that
+// does not match is ignored and rebuilt. Entries are written next to the
+// script as <name>.lzc, or into $LIZARD_CACHE_DIR when that is set.
+class ScriptCache {
+public:
+    // Bumped whenever the layout of an entry or of ASTNode changes
+    static constexpr uint32_t FORMAT_VERSION = 2;
+
+    // The cached Program for `source`, with positions pointing at
+    // `file_id`, or nullptr on a miss
+    static std::unique_ptr<Program> load(const SourceFile& source, uint32_t file_id);
+    // Best effort; a cache that cannot be written is not an error
+    static void store(const Program& program, const SourceFile& source);
+
+    static std::string pathFor(const std::string& script_path);
+    static uint64_t hash(std::string_view text);
+};
+
+} // namespace Lizard
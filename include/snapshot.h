@@ -0,0 +1,29 @@
+#pragma once
+#include "environment.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Lizard {
+
+// The variables a prelude script left behind. `lizard --snapshot-out`
+// writes one after running the prelude; `--snapshot-in` maps it back in so
+// the main script starts on top of those variables instead of re-running
+// the prelude. Declaration positions keep pointing at the prelude file by
+// name, so notes in later errors still say where a variable came from.
+struct Snapshot {
+    // Bumped whenever the layout of a snapshot changes
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+    std::vector<std::string> names; // slot order
+    std::vector<Variable> variables;
+
+    // Returns false if the file could not be written
+    static bool save(const std::string& path, const std::vector<std::string>& slot_names,
+                     const Environment& environment);
+    // nullptr if the file is missing, corrupt or from another interpreter
+    static std::unique_ptr<Snapshot> load(const std::string& path);
+};
+
+} // namespace Lizard
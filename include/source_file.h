@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Lizard {
+
+// An immutable, loaded source file. Regular files are memory-mapped; pipes
+// and other unmappable inputs are read into an owned buffer instead. The
+// line index is only built the first time a line is requested, which in
+// practice means when a diagnostic is formatted.
+class SourceFile {
+public:
+    // Largest source that can be lexed whole: token offsets and the line
+    // index are 32-bit. Bigger scripts can still run with --stream.
+    static constexpr size_t MAX_SIZE = UINT32_MAX;
+    
+    // Returns nullptr if the file cannot be opened or read
+    static std::shared_ptr<SourceFile> open(const std::string& path);
+    // Wraps source text that is already in memory
+    static std::shared_ptr<SourceFile> fromString(const std::string& name, std::string text);
+    
+    ~SourceFile();
+    SourceFile(const SourceFile&) = delete;
+    SourceFile& operator=(const SourceFile&) = delete;
+    
+    const std::string& filename() const { return name; }
+    std::string_view contents() const { return std::string_view(data, size); }
+    
+    // Number of lines, counting a final line without a trailing newline
+    size_t lineCount() const;
+    // Text of a 1-based line without its newline; empty if out of range
+    std::string_view line(int line_number) const;
+    
+private:
+    SourceFile() = default;
+    
+    std::string name;
+    const char* data = nullptr;
+    size_t size = 0;
+    void* mapping = nullptr;
+    std::string buffer;
+    mutable std::vector<uint32_t> line_starts;
+    
+    void buildLineIndex() const;
+};
+
+} // namespace Lizard
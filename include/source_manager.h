@@ -0,0 +1,31 @@
+#pragma once
+#include "source_file.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace Lizard {
+
+// Registry of the files the interpreter has seen. Positions refer to files
+// by the id returned from addFile; id 0 is reserved for "no file".
+class SourceManager {
+public:
+    static uint32_t addFile(std::shared_ptr<const SourceFile> file);
+    // Registers a name whose contents are not available
+    static uint32_t addFile(const std::string& filename);
+    
+    static const std::string& filename(uint32_t file_id);
+    // The loaded file, or nullptr if only its name is known
+    static const SourceFile* file(uint32_t file_id);
+    static std::shared_ptr<const SourceFile> sharedFile(uint32_t file_id);
+    // Like file(), but a regular file known only by name is read on the
+    // spot and kept, e.g. for a diagnostic quoting the prelude behind a
+    // snapshot. nullptr if it cannot be read.
+    static const SourceFile* loadFile(uint32_t file_id);
+    
+    // Drops the manager's reference to a file's contents; its name stays
+    // registered and diagnostics that still hold the file keep it alive
+    static void releaseFile(uint32_t file_id);
+};
+
+} // namespace Lizard
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace Lizard {
+
+// Reads a source file front to back in fixed-size chunks for the streaming
+// front end. Only the bytes that have not been discarded are kept, so memory
+// follows how far the lexer has to look back, not the size of the file.
+class SourceStream {
+public:
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    // Returns nullptr if the file cannot be opened
+    static std::unique_ptr<SourceStream> open(const std::string& path);
+
+    ~SourceStream();
+    SourceStream(const SourceStream&) = delete;
+    SourceStream& operator=(const SourceStream&) = delete;
+
+    // Everything read and not yet discarded. Invalidated by fill() and
+    // discard(); offsets into it only change on discard().
+    std::string_view buffered() const { return buffer; }
+
+    // Appends the next chunk; false at end of file or on a read error
+    bool fill();
+    // Drops the first `count` buffered bytes
+    void discard(size_t count) { buffer.erase(0, count); }
+
+private:
+    explicit SourceStream(int fd) : fd(fd) {}
+
+    int fd;
+    bool at_end = false;
+    std::string buffer;
+};
+
+} // namespace Lizard
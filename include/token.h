@@ -1,10 +1,13 @@
 #pragma once
-#include <functional>
+#include <cstdint>
+#include <cstring>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace Lizard {
 
-enum class TokenType {
+enum class TokenType : uint8_t {
   // Literals
   STRING,
   INTEGER,
@@ -33,25 +36,74 @@ enum class TokenType {
   LEFT_PAREN,   // (
   RIGHT_PAREN,  // )
   NEWLINE,
+  // A character the lexer rejected and already reported
+  ERROR,
   EOF_TOKEN
 };
 
+// A location in a source file. Files are referred to by their id in the
+// SourceManager so that copying a Position never allocates.
 struct Position {
-  std::string filename;
   int line;
   int column;
+  uint32_t file;
 
-  Position(const std::string &file = "", int l = 1, int c = 1)
-      : filename(file), line(l), column(c) {}
+  Position(uint32_t file_id = 0, int l = 1, int c = 1)
+      : line(l), column(c), file(file_id) {}
+
+  const std::string &filename() const;
 };
 
+// A token is a 16-byte view into the buffer it was lexed from. Its text is
+// recovered through the owning TokenList. String literals whose escapes had
+// to be rewritten, and text too long for `length`, are copied into the
+// list's decoded side buffer instead, as a 32-bit length followed by the
+// bytes. Offsets are 32-bit, which is why SourceFile::MAX_SIZE caps
+// whole-file lexing.
 struct Token {
+  static constexpr uint8_t DECODED = 1;
+  static constexpr uint32_t MAX_LENGTH = (1u << 23) - 1;
+
+  uint32_t offset; // into the decoded buffer when DECODED
+  uint32_t line;
+  uint32_t column;
+  uint32_t length : 23; // unused when DECODED
+  uint32_t flags : 1;
   TokenType type;
-  std::string value;
-  Position position;
 
-  Token(TokenType t, const std::string &v, const Position &pos)
-      : type(t), value(v), position(pos) {}
+  Token(TokenType t, uint32_t off, uint32_t len, uint32_t l, uint32_t c,
+        uint8_t f = 0)
+      : offset(off), line(l), column(c), length(len & MAX_LENGTH),
+        flags(f & DECODED), type(t) {}
+};
+
+static_assert(sizeof(Token) == 16, "Token should stay 16 bytes");
+
+// Text of the decoded record at `offset` in `buffer`
+inline std::string_view decodedText(std::string_view buffer, uint32_t offset) {
+  uint32_t length;
+  std::memcpy(&length, buffer.data() + offset, sizeof(length));
+  return buffer.substr(offset + sizeof(length), length);
+}
+
+// The lexer's output: compact tokens over a borrowed source buffer
+struct TokenList {
+  std::string_view source;
+  uint32_t file = 0;
+  std::vector<Token> tokens;
+  std::string decoded;
+
+  std::string_view text(const Token &token) const {
+    if (token.flags & Token::DECODED) {
+      return decodedText(decoded, token.offset);
+    }
+    return std::string_view(source.data() + token.offset, token.length);
+  }
+
+  Position position(const Token &token) const {
+    return Position(file, static_cast<int>(token.line),
+                    static_cast<int>(token.column));
+  }
 };
 
-} // namespace Lizard
\ No newline at end of file
+} // namespace Lizard
@@ -0,0 +1,50 @@
+#pragma once
+#include "ast.h"
+#include "value.h"
+#include <ostream>
+#include <vector>
+
+namespace Lizard {
+
+// The specialized handler a binary operation site has settled on. A site
+// starts UNINITIALIZED, picks a handler from the operand types it sees
+// first, and drops to GENERIC for good the first time its guard fails.
+enum class BinaryHandler : uint8_t {
+    UNINITIALIZED,
+    GENERIC,
+    INT_INT,       // both integer immediates
+    FLOAT_FLOAT,
+    INT_FLOAT,     // an immediate and a float, either order
+    STRING_ANY     // '+' with a string on either side
+};
+
+// Feedback for one binary operation in the program. `hits` counts runs of
+// the specialized handler and `misses` counts runs of the generic path,
+// including the run that failed a guard.
+struct BinarySite {
+    BinaryHandler handler = BinaryHandler::UNINITIALIZED;
+    BinaryOperator op = BinaryOperator::ADD;
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+    const Position* position = nullptr; // set on first run
+};
+
+class TypeFeedback {
+public:
+    // Same result and errors as ArithmeticEvaluator::evaluate
+    static Value evaluate(BinarySite& site, BinaryOperator op, const Value& left,
+                          const Value& right, const Position& pos);
+    
+    // Totals per handler followed by the sites that missed most
+    static void printReport(std::ostream& out, const std::vector<BinarySite>& sites);
+    
+    static const char* handlerName(BinaryHandler handler);
+    
+private:
+    static BinaryHandler select(BinaryOperator op, const Value& left, const Value& right);
+    // False when the guard fails or the fast path cannot produce the result
+    static bool tryHandler(BinaryHandler handler, BinaryOperator op, const Value& left,
+                           const Value& right, Value& result);
+};
+
+} // namespace Lizard
@@ -1,6 +1,10 @@
 #pragma once
+#include "bigint.h"
+#include <cassert>
+#include <climits>
+#include <cstdint>
+#include <cstring>
 #include <string>
-#include <variant>
 
 namespace Lizard {
 
@@ -12,35 +16,201 @@ enum class ValueType {
     NIL
 };
 
-class Value {
+// Operand types of a binary operation that are known before it runs,
+// packed into one byte so it fits in AST nodes and instructions.
+class TypePair {
 public:
-    std::variant<std::string, int, double, bool, std::nullptr_t> data;
+    TypePair() = default;
+    TypePair(ValueType left, ValueType right)
+        : bits(static_cast<uint8_t>((static_cast<unsigned>(left) + 1) |
+                                    ((static_cast<unsigned>(right) + 1) << 4))) {}
+    
+    bool known() const { return bits != 0; }
+    ValueType left() const { return static_cast<ValueType>((bits & 0xF) - 1); }
+    ValueType right() const { return static_cast<ValueType>((bits >> 4) - 1); }
     
-    Value();
+private:
+    uint8_t bits = 0;
+};
+
+// Reference-counted heap storage behind string and big integer Values.
+struct HeapObject {
+    uint32_t refcount = 1;
+};
+
+struct StringObject : HeapObject {
+    std::string data;
+
+    explicit StringObject(std::string s) : data(std::move(s)) {}
+};
+
+struct BigIntObject : HeapObject {
+    BigInt data;
+
+    explicit BigIntObject(BigInt n) : data(std::move(n)) {}
+};
+
+// A Value is a single NaN-boxed 64-bit word. Doubles are stored as their raw
+// IEEE bits (NaNs are canonicalized to the positive quiet NaN); every other
+// type lives in the negative quiet-NaN space, with a 3-bit tag in bits 48-50
+// and a 48-bit payload holding the immediate or the heap object pointer.
+// Integers are 48-bit signed immediates; anything wider is a BigIntObject,
+// so both encodings are the one INTEGER type to the language.
+class Value {
+public:
+    Value() : bits(NIL_BITS) {}
     Value(const std::string& str);
-    Value(int i);
+    Value(std::string&& str);
+    Value(const char* str);
+    Value(int i) : bits(smallIntegerBits(i)) {}
+    Value(int64_t i) : bits(fitsSmallInteger(i) ? smallIntegerBits(i) : boxBigInteger(i)) {}
+    Value(BigInt&& n);
     Value(double f);
-    Value(bool b);
-    Value(std::nullptr_t);
+    Value(bool b) : bits(BOOLEAN_TAG | static_cast<uint64_t>(b)) {}
+    Value(std::nullptr_t) : bits(NIL_BITS) {}
+
+    Value(const Value& other) : bits(other.bits) { retain(); }
+    Value(Value&& other) noexcept : bits(other.bits) { other.bits = NIL_BITS; }
+    ~Value() { release(); }
+
+    Value& operator=(const Value& other) {
+        other.retain();
+        release();
+        bits = other.bits;
+        return *this;
+    }
+
+    Value& operator=(Value&& other) noexcept {
+        if (this != &other) {
+            release();
+            bits = other.bits;
+            other.bits = NIL_BITS;
+        }
+        return *this;
+    }
     
-    ValueType getType() const;
+    ValueType getType() const {
+        if (bits < BOX_BASE) {
+            return ValueType::FLOAT;
+        }
+        static constexpr ValueType tag_types[8] = {
+            ValueType::FLOAT, ValueType::NIL, ValueType::BOOLEAN, ValueType::INTEGER,
+            ValueType::STRING, ValueType::INTEGER, ValueType::NIL, ValueType::NIL
+        };
+        return tag_types[(bits >> 48) & 7];
+    }
+
     std::string toString() const;
+    // Appends the toString() text to `out` without building a temporary
+    void appendTo(std::string& out) const;
     
     template<typename T>
-    T get() const {
-        return std::get<T>(data);
-    }
+    T get() const;
+
+    // Borrowed access to a string Value's contents without copying
+    const std::string& asString() const { return static_cast<StringObject*>(heapObject())->data; }
+    // Borrowed access to a big integer Value
+    const BigInt& asBigInt() const { return static_cast<BigIntObject*>(heapObject())->data; }
+    // Any integer as a BigInt, for the slow paths
+    BigInt toBigInt() const;
+
+    // The boxed encoding itself; identifies non-string values exactly
+    uint64_t raw() const { return bits; }
     
-    bool isString() const { return getType() == ValueType::STRING; }
-    bool isInteger() const { return getType() == ValueType::INTEGER; }
-    bool isFloat() const { return getType() == ValueType::FLOAT; }
-    bool isBoolean() const { return getType() == ValueType::BOOLEAN; }
-    bool isNil() const { return getType() == ValueType::NIL; }
+    bool isString() const { return (bits & TAG_MASK) == STRING_TAG; }
+    bool isInteger() const { return isSmallInteger() || isBigInteger(); }
+    bool isSmallInteger() const { return (bits & TAG_MASK) == INTEGER_TAG; }
+    bool isBigInteger() const { return (bits & TAG_MASK) == BIGINT_TAG; }
+    bool isFloat() const { return bits < BOX_BASE; }
+    bool isBoolean() const { return (bits & TAG_MASK) == BOOLEAN_TAG; }
+    bool isNil() const { return bits == NIL_BITS; }
+
+private:
+    friend class JitCompiler; // generates code against the encoding below
     
-    template<typename T>
-    const T& get() const {
-        return std::get<T>(data);
+    static constexpr uint64_t BOX_BASE = 0xFFF9000000000000ULL;
+    static constexpr uint64_t TAG_MASK = 0xFFFF000000000000ULL;
+    static constexpr uint64_t PAYLOAD_MASK = 0x0000FFFFFFFFFFFFULL;
+    static constexpr uint64_t NIL_TAG = 0xFFF9000000000000ULL;
+    static constexpr uint64_t BOOLEAN_TAG = 0xFFFA000000000000ULL;
+    static constexpr uint64_t INTEGER_TAG = 0xFFFB000000000000ULL;
+    static constexpr uint64_t STRING_TAG = 0xFFFC000000000000ULL;
+    static constexpr uint64_t BIGINT_TAG = 0xFFFD000000000000ULL;
+    static constexpr uint64_t NIL_BITS = NIL_TAG;
+    static constexpr uint64_t CANONICAL_NAN = 0x7FF8000000000000ULL;
+
+public:
+    // Range of the integer immediates
+    static constexpr int64_t SMALL_INT_MIN = -(int64_t(1) << 47);
+    static constexpr int64_t SMALL_INT_MAX = (int64_t(1) << 47) - 1;
+
+    static bool fitsSmallInteger(int64_t i) { return i >= SMALL_INT_MIN && i <= SMALL_INT_MAX; }
+
+private:
+    uint64_t bits;
+
+    static uint64_t smallIntegerBits(int64_t i) {
+        return INTEGER_TAG | (static_cast<uint64_t>(i) & PAYLOAD_MASK);
+    }
+    static uint64_t boxBigInteger(int64_t i);
+
+    // Tags at or above STRING_TAG point at a HeapObject
+    bool isHeap() const { return bits >= STRING_TAG; }
+
+    HeapObject* heapObject() const {
+        return reinterpret_cast<HeapObject*>(static_cast<uintptr_t>(bits & PAYLOAD_MASK));
     }
+
+    void retain() const {
+        if (isHeap()) {
+            heapObject()->refcount++;
+        }
+    }
+
+    void release() {
+        if (isHeap() && --heapObject()->refcount == 0) {
+            destroy();
+        }
+    }
+
+    void destroy();
 };
 
-} // namespace Lizard
\ No newline at end of file
+// Only for immediates; a BigInt must go through asBigInt() or toBigInt()
+template<>
+inline int64_t Value::get<int64_t>() const {
+    assert(isSmallInteger());
+    // Sign-extend the 48-bit payload
+    return static_cast<int64_t>(bits << 16) >> 16;
+}
+
+// Only for immediates that fit in an int
+template<>
+inline int Value::get<int>() const {
+    int64_t value = get<int64_t>();
+    assert(value >= INT_MIN && value <= INT_MAX);
+    return static_cast<int>(value);
+}
+
+template<>
+inline double Value::get<double>() const {
+    double f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+template<>
+inline bool Value::get<bool>() const {
+    return (bits & 1) != 0;
+}
+
+template<>
+inline std::string Value::get<std::string>() const {
+    return asString();
+}
+
+inline BigInt Value::toBigInt() const {
+    return isBigInteger() ? asBigInt() : BigInt(get<int64_t>());
+}
+
+} // namespace Lizard
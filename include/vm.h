@@ -0,0 +1,39 @@
+#pragma once
+#include "bytecode.h"
+#include "environment.h"
+#include "jit.h"
+#include "output_buffer.h"
+#include "type_feedback.h"
+#include <memory>
+#include <ostream>
+#include <vector>
+
+namespace Lizard {
+
+class VirtualMachine {
+private:
+    Environment environment;
+    std::vector<Value> registers;
+    std::vector<BinarySite> sites; // indexed by pc
+    OutputBuffer& output;
+    bool jit_enabled = false;
+    std::unique_ptr<Jit> jit;
+    const std::vector<Variable>* prelude = nullptr;
+
+    Value binary(BinaryOperator op, const Instruction& ins, size_t pc, const Position& pos);
+
+public:
+    explicit VirtualMachine(OutputBuffer& output) : output(output) {}
+
+    // Compile long arithmetic runs to native code before running
+    void setJitEnabled(bool enabled) { jit_enabled = enabled; }
+    // Variables the program starts with, in its first slots
+    void setPrelude(const std::vector<Variable>& variables) { prelude = &variables; }
+    // The variables as the last run() left them
+    const Environment& globals() const { return environment; }
+
+    void run(const Chunk& chunk);
+    void printProfile(std::ostream& out) const;
+};
+
+} // namespace Lizard
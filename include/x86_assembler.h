@@ -0,0 +1,109 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Lizard {
+
+enum class Reg : uint8_t {
+    RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+    R8, R9, R10, R11, R12, R13, R14, R15
+};
+
+enum class Xmm : uint8_t { XMM0, XMM1, XMM2 };
+
+enum class Condition : uint8_t {
+    O = 0x0, NO = 0x1, B = 0x2, AE = 0x3, E = 0x4, NE = 0x5, BE = 0x6, A = 0x7,
+    S = 0x8, NS = 0x9, P = 0xA, NP = 0xB, L = 0xC, GE = 0xD, LE = 0xE, G = 0xF
+};
+
+// [base + disp]
+struct Mem {
+    Reg base;
+    int32_t disp;
+};
+
+// Emits the small subset of x86-64 the JIT needs into a byte buffer.
+// Memory operands use the shortest displacement that fits; jumps always
+// use a 32-bit offset so labels can be bound after the jumps that use them.
+class X86Assembler {
+public:
+    using Label = uint32_t;
+
+    Label newLabel();
+    void bind(Label label);
+    // Resolves every jump; call once after the last instruction
+    void finish();
+    // Forgets all code and labels so the buffer can be reused
+    void clear();
+    
+    const std::vector<uint8_t>& code() const { return bytes; }
+    size_t size() const { return bytes.size(); }
+
+    void push(Reg reg);
+    void pop(Reg reg);
+    void ret() { byte(0xC3); }
+    void call(Reg target);
+    void call(Label target);
+
+    void mov(Reg dst, Reg src);
+    void mov(Reg dst, Mem src);
+    void mov(Mem dst, Reg src);
+    void mov(Reg dst, uint64_t imm);
+    void mov32(Reg dst, uint32_t imm);
+    void mov8(Mem dst, uint8_t imm);
+    void lea(Reg dst, Mem src);
+
+    void add(Reg dst, Reg src)  { alu(0x01, dst, src); }
+    void sub(Reg dst, Reg src)  { alu(0x29, dst, src); }
+    void or_(Reg dst, Reg src)  { alu(0x09, dst, src); }
+    void cmp(Reg a, Reg b)      { alu(0x39, a, b); }
+    void test(Reg a, Reg b)     { alu(0x85, a, b); }
+    void imul(Reg dst, Reg src);
+    void cqo();
+    void idiv(Reg divisor);
+    void add(Reg dst, int8_t imm) { aluImm8(0, dst, imm); }
+    void sub(Reg dst, int8_t imm) { aluImm8(5, dst, imm); }
+    void cmp32(Reg a, uint32_t imm);
+    void cmp8(Mem a, uint8_t imm);
+
+    void shl(Reg reg, uint8_t count) { shift(4, reg, count); }
+    void shr(Reg reg, uint8_t count) { shift(5, reg, count); }
+    void sar(Reg reg, uint8_t count) { shift(7, reg, count); }
+
+    void movq(Xmm dst, Reg src);
+    void movq(Reg dst, Xmm src);
+    void cvtsi2sd(Xmm dst, Reg src);
+    void addsd(Xmm dst, Xmm src) { sse(0xF2, 0x58, dst, src); }
+    void subsd(Xmm dst, Xmm src) { sse(0xF2, 0x5C, dst, src); }
+    void mulsd(Xmm dst, Xmm src) { sse(0xF2, 0x59, dst, src); }
+    void divsd(Xmm dst, Xmm src) { sse(0xF2, 0x5E, dst, src); }
+    void ucomisd(Xmm a, Xmm b)   { sse(0x66, 0x2E, a, b); }
+    void xorpd(Xmm dst, Xmm src) { sse(0x66, 0x57, dst, src); }
+
+    void jmp(Label target);
+    void j(Condition condition, Label target);
+
+private:
+    struct Fixup {
+        size_t offset; // of the rel32 field
+        Label target;
+    };
+
+    std::vector<uint8_t> bytes;
+    std::vector<int64_t> label_offsets;
+    std::vector<Fixup> fixups;
+
+    void byte(uint8_t b) { bytes.push_back(b); }
+    void imm32(uint32_t value);
+    void rex(bool wide, unsigned reg, unsigned base);
+    void modrm(unsigned reg, Reg rm);
+    void modrm(unsigned reg, Mem mem);
+    void alu(uint8_t opcode, Reg dst, Reg src);
+    void aluImm8(unsigned extension, Reg dst, int8_t imm);
+    void shift(unsigned extension, Reg reg, uint8_t count);
+    void sse(uint8_t prefix, uint8_t opcode, Xmm dst, Xmm src);
+    void rel32(Label target);
+};
+
+} // namespace Lizard
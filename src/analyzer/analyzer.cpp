@@ -0,0 +1,189 @@
+#include "analyzer.h"
+#include "eval_arithmetic.h"
+
+namespace Lizard {
+
+void StaticAnalyzer::analyze(Program& program, const std::vector<Variable>* prelude) {
+    this->program = &program;
+    this->prelude = prelude;
+    markTargets();
+    propagateConstants();
+    inferTypes();
+    
+    is_target.clear();
+    is_target.shrink_to_fit();
+    node_types.clear();
+    node_types.shrink_to_fit();
+}
+
+void StaticAnalyzer::markTargets() {
+    is_target.assign(program->nodes.size(), false);
+    for (NodeIndex stmt : program->statements) {
+        const ASTNode& node = (*program)[stmt];
+        if (node.type == ASTNodeType::VARIABLE_DECLARATION ||
+            node.type == ASTNodeType::VARIABLE_ASSIGNMENT) {
+            is_target[node.target()] = true;
+        }
+    }
+}
+
+// Children are emitted before their parents and statements in source
+// order, so one pass in node order sees every declaration before the
+// reads that follow it and every operand before its expression.
+void StaticAnalyzer::propagateConstants() {
+    fixed_values.assign(program->slot_names.size(), NO_CONSTANT);
+    
+    for (NodeIndex i = 0; i < program->nodes.size(); ++i) {
+        ASTNode& node = (*program)[i];
+        switch (node.type) {
+            case ASTNodeType::IDENTIFIER:
+                if (!is_target[i] && fixed_values[node.slot()] == NO_CONSTANT) {
+                    fixed_values[node.slot()] = preludeConstant(node.slot());
+                }
+                if (!is_target[i] && fixed_values[node.slot()] != NO_CONSTANT) {
+                    node = ASTNode::literal(fixed_values[node.slot()]);
+                }
+                break;
+            case ASTNodeType::BINARY_EXPRESSION: {
+                const ASTNode& left = (*program)[node.left()];
+                const ASTNode& right = (*program)[node.right()];
+                if (left.type != ASTNodeType::LITERAL || right.type != ASTNodeType::LITERAL) {
+                    break;
+                }
+                const Value& left_value = program->constants[left.constant()];
+                const Value& right_value = program->constants[right.constant()];
+                if (ArithmeticEvaluator::canEvaluate(node.op, left_value, right_value)) {
+                    Value result = ArithmeticEvaluator::evaluate(node.op, left_value, right_value,
+                                                                 program->position(i));
+                    node = ASTNode::literal(program->constants.add(result));
+                }
+                break;
+            }
+            case ASTNodeType::VARIABLE_DECLARATION:
+                // Once a fixed declaration has run, nothing can change the slot:
+                // a later definition or assignment raises an error instead
+                if (node.isConstant() && node.value() != NO_NODE &&
+                    (*program)[node.value()].type == ASTNodeType::LITERAL) {
+                    fixed_values[(*program)[node.target()].slot()] = (*program)[node.value()].constant();
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+// Prelude constants only enter the pool once the program reads them
+uint32_t StaticAnalyzer::preludeConstant(uint32_t slot) {
+    if (!prelude || slot >= prelude->size()) {
+        return NO_CONSTANT;
+    }
+    const Variable& var = (*prelude)[slot];
+    if (!var.is_constant || !var.is_initialized) {
+        return NO_CONSTANT;
+    }
+    return program->constants.add(var.value);
+}
+
+// Optimistic fixed point: slots start at NONE and only move up the lattice,
+// so a self-referencing update such as `x = x + 1` keeps an integer slot
+// integer. Reading a slot that was never written raises an error, which is
+// why a NONE operand makes the whole expression NONE.
+void StaticAnalyzer::inferTypes() {
+    node_types.assign(program->nodes.size(), NONE);
+    slot_types.assign(program->slot_names.size(), NONE);
+    if (prelude) {
+        for (uint32_t slot = 0; slot < prelude->size(); ++slot) {
+            const Variable& var = (*prelude)[slot];
+            if (var.is_initialized) {
+                slot_types[slot] = typeOf(var.value.getType());
+            }
+        }
+    }
+    
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (NodeIndex i = 0; i < program->nodes.size(); ++i) {
+            const ASTNode& node = (*program)[i];
+            switch (node.type) {
+                case ASTNodeType::LITERAL:
+                    node_types[i] = typeOf(program->constants[node.constant()].getType());
+                    break;
+                case ASTNodeType::IDENTIFIER:
+                    node_types[i] = is_target[i] ? NONE : slot_types[node.slot()];
+                    break;
+                case ASTNodeType::BINARY_EXPRESSION:
+                    node_types[i] = resultType(node.op, node_types[node.left()], node_types[node.right()]);
+                    break;
+                case ASTNodeType::VARIABLE_DECLARATION:
+                case ASTNodeType::VARIABLE_ASSIGNMENT: {
+                    if (node.value() == NO_NODE) {
+                        break;
+                    }
+                    StaticType& slot_type = slot_types[(*program)[node.target()].slot()];
+                    StaticType joined = join(slot_type, node_types[node.value()]);
+                    if (joined != slot_type) {
+                        slot_type = joined;
+                        changed = true;
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+    }
+    
+    for (NodeIndex i = 0; i < program->nodes.size(); ++i) {
+        ASTNode& node = (*program)[i];
+        if (node.type != ASTNodeType::BINARY_EXPRESSION) {
+            continue;
+        }
+        StaticType left = node_types[node.left()];
+        StaticType right = node_types[node.right()];
+        if (isConcrete(left) && isConcrete(right)) {
+            node.operand_types = TypePair(valueType(left), valueType(right));
+        }
+    }
+}
+
+StaticAnalyzer::StaticType StaticAnalyzer::join(StaticType a, StaticType b) {
+    if (a == NONE) return b;
+    if (b == NONE) return a;
+    return a == b ? a : ANY;
+}
+
+StaticAnalyzer::StaticType StaticAnalyzer::resultType(BinaryOperator op, StaticType left, StaticType right) {
+    if (left == NONE || right == NONE) {
+        return NONE;
+    }
+    
+    const StaticType string_type = typeOf(ValueType::STRING);
+    if (op == BinaryOperator::ADD && (left == string_type || right == string_type)) {
+        return string_type;
+    }
+    if (left == ANY || right == ANY) {
+        return ANY;
+    }
+    
+    const StaticType integer_type = typeOf(ValueType::INTEGER);
+    const StaticType float_type = typeOf(ValueType::FLOAT);
+    bool numeric = (left == integer_type || left == float_type) &&
+                   (right == integer_type || right == float_type);
+    if (!numeric) {
+        return NONE; // a type error, so no value is produced
+    }
+    
+    switch (op) {
+        case BinaryOperator::DIVIDE:
+            return float_type;
+        case BinaryOperator::INT_DIV:
+        case BinaryOperator::MODULO:
+            return integer_type;
+        default:
+            return left == integer_type && right == integer_type ? integer_type : float_type;
+    }
+}
+
+} // namespace Lizard
@@ -0,0 +1,246 @@
+#include "cpp_emitter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace Lizard {
+
+namespace {
+
+const char* operatorName(BinaryOperator op) {
+    switch (op) {
+        case BinaryOperator::ADD:      return "BinaryOperator::ADD";
+        case BinaryOperator::SUBTRACT: return "BinaryOperator::SUBTRACT";
+        case BinaryOperator::MULTIPLY: return "BinaryOperator::MULTIPLY";
+        case BinaryOperator::DIVIDE:   return "BinaryOperator::DIVIDE";
+        case BinaryOperator::INT_DIV:  return "BinaryOperator::INT_DIV";
+        case BinaryOperator::MODULO:   return "BinaryOperator::MODULO";
+    }
+    return "BinaryOperator::ADD";
+}
+
+const char* typeName(ValueType type) {
+    switch (type) {
+        case ValueType::STRING:  return "ValueType::STRING";
+        case ValueType::INTEGER: return "ValueType::INTEGER";
+        case ValueType::FLOAT:   return "ValueType::FLOAT";
+        case ValueType::BOOLEAN: return "ValueType::BOOLEAN";
+        case ValueType::NIL:     return "ValueType::NIL";
+    }
+    return "ValueType::NIL";
+}
+
+std::string location(const Position& pos) {
+    return std::to_string(pos.line) + ", " + std::to_string(pos.column);
+}
+
+} // namespace
+
+void CppEmitter::emit(const Program& program, const SourceFile& source, std::ostream& out) {
+    this->program = &program;
+    this->out = &out;
+
+    out << "// Generated by lizard --emit-cpp from " << source.filename() << "\n"
+        << "#include \"aot_runtime.h\"\n"
+        << "#include <limits>\n\n"
+        << "using namespace Lizard;\n\n"
+        << "namespace {\n\n";
+
+    emitSource(source);
+    emitConstants();
+
+    size_t part_count = 0;
+    size_t count = program.statements.size();
+    do {
+        size_t end = std::min(count, (part_count + 1) * STATEMENTS_PER_PART);
+        out << "void part" << part_count << "(CompiledProgram& p) {\n"
+            << "    const Value* k = p.constants.data();\n"
+            << "    (void)k;\n";
+        for (size_t i = part_count * STATEMENTS_PER_PART; i < end; ++i) {
+            emitStatement(program.statements[i]);
+        }
+        out << "}\n\n";
+        part_count++;
+    } while (part_count * STATEMENTS_PER_PART < count);
+
+    out << "} // namespace\n\n"
+        << "int main(int argc, char* argv[]) {\n"
+        << "    static const CompiledProgram::Part parts[] = {";
+    for (size_t i = 0; i < part_count; ++i) {
+        out << (i % 8 == 0 ? "\n        " : " ") << "part" << i << ",";
+    }
+    out << "\n    };\n"
+        << "    CompiledProgram program(FILENAME, std::string_view(SOURCE, sizeof(SOURCE) - 1), SLOT_NAMES);\n"
+        << "    loadConstants(program.constants);\n"
+        << "    return program.run(argc, argv, parts, " << part_count << ");\n"
+        << "}\n";
+}
+
+void CppEmitter::emitSource(const SourceFile& source) {
+    std::ostream& out = *this->out;
+    out << "const char* const FILENAME = " << quote(source.filename()) << ";\n\n";
+
+    // One literal per source line keeps the embedded text readable
+    out << "const char SOURCE[] =";
+    std::string_view text = source.contents();
+    if (text.empty()) {
+        out << " \"\"";
+    }
+    while (!text.empty()) {
+        size_t newline = text.find('\n');
+        size_t length = newline == std::string_view::npos ? text.size() : newline + 1;
+        out << "\n    " << quote(text.substr(0, length));
+        text.remove_prefix(length);
+    }
+    out << ";\n\n";
+
+    out << "const std::vector<std::string> SLOT_NAMES = {";
+    for (size_t i = 0; i < program->slot_names.size(); ++i) {
+        out << (i % 8 == 0 ? "\n    " : " ") << quote(program->slot_names[i]) << ",";
+    }
+    out << "\n};\n\n";
+}
+
+void CppEmitter::emitConstants() {
+    std::ostream& out = *this->out;
+    out << "void loadConstants(std::vector<Value>& k) {\n"
+        << "    k.reserve(" << program->constants.size() << ");\n";
+    for (const Value& value : program->constants.all()) {
+        out << "    k.emplace_back(" << constant(value) << ");\n";
+    }
+    out << "}\n\n";
+}
+
+void CppEmitter::emitStatement(NodeIndex index) {
+    std::ostream& out = *this->out;
+    const ASTNode& node = (*program)[index];
+    const Position& pos = program->position(index);
+    next_temporary = 0;
+
+    out << "    {\n";
+    switch (node.type) {
+        case ASTNodeType::VARIABLE_DECLARATION: {
+            uint32_t slot = (*program)[node.target()].slot();
+            const char* fixed = node.isConstant() ? "true" : "false";
+            if (node.value() != NO_NODE) {
+                std::string value = emitExpression(node.value());
+                out << "        p.define(" << slot << ", " << value << ", " << fixed << ", "
+                    << location(pos) << ");\n";
+            } else {
+                out << "        p.declare(" << slot << ", " << fixed << ", " << location(pos) << ");\n";
+            }
+            break;
+        }
+        case ASTNodeType::VARIABLE_ASSIGNMENT: {
+            std::string value = emitExpression(node.value());
+            out << "        p.assign(" << (*program)[node.target()].slot() << ", " << value << ", "
+                << location(pos) << ");\n";
+            break;
+        }
+        case ASTNodeType::PRINT_STATEMENT: {
+            std::string value = emitExpression(node.expression());
+            out << "        p.print(" << value << ");\n";
+            break;
+        }
+        default:
+            break;
+    }
+    out << "    }\n";
+}
+
+std::string CppEmitter::emitExpression(NodeIndex index) {
+    std::ostream& out = *this->out;
+    const ASTNode& node = (*program)[index];
+    const Position& pos = program->position(index);
+
+    switch (node.type) {
+        case ASTNodeType::LITERAL:
+            return "k[" + std::to_string(node.constant()) + "]";
+        case ASTNodeType::IDENTIFIER: {
+            std::string name = "t" + std::to_string(next_temporary++);
+            out << "        const Value& " << name << " = p.get(" << node.slot() << ", "
+                << location(pos) << ");\n";
+            return name;
+        }
+        case ASTNodeType::BINARY_EXPRESSION: {
+            // C++ leaves argument order unspecified, so operands that can
+            // raise an error are evaluated into temporaries first
+            std::string left = emitExpression(node.left());
+            std::string right = emitExpression(node.right());
+            std::string name = "t" + std::to_string(next_temporary++);
+            out << "        Value " << name << " = p.binary(" << operatorName(node.op) << ", ";
+            if (node.operand_types.known()) {
+                out << "TypePair(" << typeName(node.operand_types.left()) << ", "
+                    << typeName(node.operand_types.right()) << "), ";
+            }
+            out << left << ", " << right << ", " << location(pos) << ");\n";
+            return name;
+        }
+        default:
+            return "Value(nullptr)";
+    }
+}
+
+std::string CppEmitter::quote(std::string_view text) {
+    std::string result = "\"";
+    for (char c : text) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        switch (c) {
+            case '"':  result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n"; break;
+            case '\t': result += "\\t"; break;
+            default:
+                if (byte < 0x20 || byte >= 0x7F) {
+                    // Always three octal digits, so a following digit is not absorbed
+                    char escape[5];
+                    std::snprintf(escape, sizeof(escape), "\\%03o", byte);
+                    result += escape;
+                } else {
+                    result += c;
+                }
+        }
+    }
+    return result + "\"";
+}
+
+std::string CppEmitter::constant(const Value& value) {
+    switch (value.getType()) {
+        case ValueType::STRING: {
+            const std::string& text = value.asString();
+            return "std::string(" + quote(text) + ", " + std::to_string(text.size()) + ")";
+        }
+        case ValueType::INTEGER: {
+            if (value.isSmallInteger()) {
+                return "static_cast<int64_t>(" + std::to_string(value.get<int64_t>()) + "LL)";
+            }
+            const BigInt& number = value.asBigInt();
+            std::string digits = number.toString();
+            if (number.isNegative()) {
+                return "BigInt::subtract(BigInt(), BigInt::parse(\"" + digits.substr(1) + "\"))";
+            }
+            return "BigInt::parse(\"" + digits + "\")";
+        }
+        case ValueType::FLOAT: {
+            double number = value.get<double>();
+            if (std::isnan(number)) {
+                return "std::numeric_limits<double>::quiet_NaN()";
+            }
+            if (std::isinf(number)) {
+                return number > 0 ? "std::numeric_limits<double>::infinity()"
+                                  : "-std::numeric_limits<double>::infinity()";
+            }
+            // Hexadecimal floats round-trip exactly
+            char text[64];
+            std::snprintf(text, sizeof(text), "%a", number);
+            return text;
+        }
+        case ValueType::BOOLEAN:
+            return value.get<bool>() ? "true" : "false";
+        case ValueType::NIL:
+            return "nullptr";
+    }
+    return "nullptr";
+}
+
+} // namespace Lizard
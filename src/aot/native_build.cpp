@@ -0,0 +1,138 @@
+#include "native_build.h"
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// Set by the build system. The installed paths are relative to the directory
+// holding the lizard executable; the others point into the build tree and
+// are used when lizard runs from there.
+#ifndef LIZARD_INSTALLED_INCLUDE_DIR
+#define LIZARD_INSTALLED_INCLUDE_DIR "../include/lizard"
+#endif
+#ifndef LIZARD_INSTALLED_RUNTIME_LIBRARY
+#define LIZARD_INSTALLED_RUNTIME_LIBRARY "../lib/liblizard_runtime.a"
+#endif
+#ifndef LIZARD_INCLUDE_DIR
+#define LIZARD_INCLUDE_DIR "include"
+#endif
+#ifndef LIZARD_RUNTIME_LIBRARY
+#define LIZARD_RUNTIME_LIBRARY "liblizard_runtime.a"
+#endif
+#ifndef LIZARD_CXX_COMPILER
+#define LIZARD_CXX_COMPILER "c++"
+#endif
+
+namespace Lizard {
+
+namespace {
+
+bool writeAll(int fd, const std::string& text) {
+    size_t written = 0;
+    while (written < text.size()) {
+        ssize_t count = ::write(fd, text.data() + written, text.size() - written);
+        if (count < 0) {
+            return false;
+        }
+        written += static_cast<size_t>(count);
+    }
+    return true;
+}
+
+// Runs the command without a shell and waits for it
+bool runCommand(const std::vector<std::string>& command) {
+    std::vector<char*> argv;
+    for (const std::string& arg : command) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        return false;
+    }
+    if (pid == 0) {
+        execvp(argv[0], argv.data());
+        std::perror(argv[0]);
+        _exit(127);
+    }
+
+    int status = 0;
+    if (waitpid(pid, &status, 0) < 0) {
+        return false;
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// Directory of the running executable, or empty if it cannot be found
+std::string executableDirectory() {
+    char path[PATH_MAX];
+    ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (length <= 0) {
+        return "";
+    }
+    std::string directory(path, static_cast<size_t>(length));
+    size_t slash = directory.rfind('/');
+    return slash == std::string::npos ? "" : directory.substr(0, slash);
+}
+
+struct RuntimePaths {
+    std::string include_dir;
+    std::string library;
+};
+
+// The installed runtime next to this lizard if there is one, otherwise the
+// build tree it was built in
+RuntimePaths runtimePaths() {
+    std::string directory = executableDirectory();
+    if (!directory.empty()) {
+        RuntimePaths installed = {directory + "/" + LIZARD_INSTALLED_INCLUDE_DIR,
+                                  directory + "/" + LIZARD_INSTALLED_RUNTIME_LIBRARY};
+        if (access((installed.include_dir + "/aot_runtime.h").c_str(), R_OK) == 0 &&
+            access(installed.library.c_str(), R_OK) == 0) {
+            return installed;
+        }
+    }
+    return {LIZARD_INCLUDE_DIR, LIZARD_RUNTIME_LIBRARY};
+}
+
+} // namespace
+
+bool NativeBuild::build(const std::string& cpp_source, const std::string& output_path) {
+    const char* tmpdir = std::getenv("TMPDIR");
+    std::string path = std::string(tmpdir && *tmpdir ? tmpdir : "/tmp") + "/lizard-XXXXXX.cpp";
+    int fd = mkstemps(&path[0], 4);
+    if (fd < 0) {
+        std::cerr << "Error: Could not create a temporary file for the generated C++" << std::endl;
+        return false;
+    }
+    bool written = writeAll(fd, cpp_source);
+    close(fd);
+    if (!written) {
+        unlink(path.c_str());
+        std::cerr << "Error: Could not write the generated C++ to '" << path << "'" << std::endl;
+        return false;
+    }
+
+    RuntimePaths runtime = runtimePaths();
+    const char* cxx = std::getenv("CXX");
+    std::vector<std::string> command = {
+        cxx && *cxx ? cxx : LIZARD_CXX_COMPILER,
+        "-std=c++17", "-O2",
+        "-I", runtime.include_dir,
+        path,
+        runtime.library,
+        "-o", output_path
+    };
+    bool built = runCommand(command);
+    unlink(path.c_str());
+    if (!built) {
+        std::cerr << "Error: Compiling '" << output_path << "' with " << command[0] << " failed" << std::endl;
+    }
+    return built;
+}
+
+} // namespace Lizard
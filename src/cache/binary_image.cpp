@@ -0,0 +1,160 @@
+#include "binary_image.h"
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Lizard {
+
+namespace {
+
+enum class ValueTag : uint8_t {
+    STRING,
+    SMALL_INTEGER,
+    BIG_INTEGER,
+    FLOAT,
+    BOOLEAN,
+    NIL
+};
+
+} // namespace
+
+void ImageWriter::value(const Value& value) {
+    switch (value.getType()) {
+        case ValueType::STRING:
+            scalar(ValueTag::STRING);
+            text(value.asString());
+            break;
+        case ValueType::INTEGER:
+            if (value.isSmallInteger()) {
+                scalar(ValueTag::SMALL_INTEGER);
+                scalar(value.get<int64_t>());
+            } else {
+                scalar(ValueTag::BIG_INTEGER);
+                text(value.asBigInt().toString());
+            }
+            break;
+        case ValueType::FLOAT:
+            scalar(ValueTag::FLOAT);
+            scalar(value.get<double>());
+            break;
+        case ValueType::BOOLEAN:
+            scalar(ValueTag::BOOLEAN);
+            scalar(static_cast<uint8_t>(value.get<bool>()));
+            break;
+        case ValueType::NIL:
+            scalar(ValueTag::NIL);
+            break;
+    }
+}
+
+bool ImageWriter::commit(const std::string& path) const {
+    std::string temporary = path + ".XXXXXX";
+    int fd = mkstemp(&temporary[0]);
+    if (fd < 0) {
+        return false;
+    }
+
+    const char* data = buffer.data();
+    size_t remaining = buffer.size();
+    while (remaining > 0) {
+        ssize_t count = ::write(fd, data, remaining);
+        if (count < 0) {
+            break;
+        }
+        data += count;
+        remaining -= static_cast<size_t>(count);
+    }
+    fchmod(fd, 0644);
+    bool closed = close(fd) == 0;
+    if (remaining > 0 || !closed || rename(temporary.c_str(), path.c_str()) != 0) {
+        unlink(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool ImageReader::value(Value& out) {
+    ValueTag tag;
+    if (!scalar(tag)) {
+        return false;
+    }
+    switch (tag) {
+        case ValueTag::STRING: {
+            std::string contents;
+            if (!text(contents)) {
+                return false;
+            }
+            out = Value(std::move(contents));
+            return true;
+        }
+        case ValueTag::SMALL_INTEGER: {
+            int64_t number;
+            if (!scalar(number)) {
+                return false;
+            }
+            out = Value(number);
+            return true;
+        }
+        case ValueTag::BIG_INTEGER: {
+            std::string digits;
+            if (!text(digits) || digits.empty()) {
+                return false;
+            }
+            bool negative = digits[0] == '-';
+            std::string_view magnitude = std::string_view(digits).substr(negative ? 1 : 0);
+            if (magnitude.empty() || magnitude.find_first_not_of("0123456789") != std::string_view::npos) {
+                return false;
+            }
+            BigInt number = BigInt::parse(magnitude);
+            out = Value(negative ? BigInt::subtract(BigInt(), number) : std::move(number));
+            return true;
+        }
+        case ValueTag::FLOAT: {
+            double number;
+            if (!scalar(number)) {
+                return false;
+            }
+            out = Value(number);
+            return true;
+        }
+        case ValueTag::BOOLEAN: {
+            uint8_t flag;
+            if (!scalar(flag)) {
+                return false;
+            }
+            out = Value(flag != 0);
+            return true;
+        }
+        case ValueTag::NIL:
+            out = Value(nullptr);
+            return true;
+    }
+    return false;
+}
+
+MappedImage::MappedImage(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void* mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            data = static_cast<const char*>(mapping);
+            size = static_cast<size_t>(info.st_size);
+        }
+    }
+    close(fd);
+}
+
+MappedImage::~MappedImage() {
+    if (data) {
+        munmap(const_cast<char*>(data), size);
+    }
+}
+
+} // namespace Lizard
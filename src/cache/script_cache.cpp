@@ -0,0 +1,209 @@
+#include "script_cache.h"
+#include "binary_image.h"
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+
+// Set by the build system from the project version
+#ifndef LIZARD_VERSION
+#define LIZARD_VERSION "unknown"
+#endif
+
+namespace Lizard {
+
+namespace {
+
+// Also tells the byte order apart, since entries are in native order
+constexpr uint32_t MAGIC = 0x435A4C7F; // "\x7FLZC" little-endian
+
+static_assert(std::is_trivially_copyable<ASTNode>::value, "ASTNode is stored as raw bytes");
+
+struct Header {
+    uint32_t magic;
+    uint32_t format_version;
+    char interpreter_version[16];
+    uint64_t source_hash;
+    uint64_t source_size;
+    uint32_t node_count;
+    uint32_t statement_count;
+    uint32_t constant_count;
+    uint32_t name_count;
+    uint32_t slot_name_count;
+    uint32_t binary_sites;
+    // Hash of everything after the header. The payload is trusted once it
+    // matches, so a corrupt entry must never get as far as being run.
+    uint64_t payload_hash;
+};
+
+Header makeHeader(const SourceFile& source) {
+    Header header{};
+    header.magic = MAGIC;
+    header.format_version = ScriptCache::FORMAT_VERSION;
+    std::strncpy(header.interpreter_version, LIZARD_VERSION, sizeof(header.interpreter_version) - 1);
+    header.source_hash = ScriptCache::hash(source.contents());
+    header.source_size = source.contents().size();
+    return header;
+}
+
+bool readEntry(ImageReader& in, const Header& expected, uint32_t file_id, Program& program) {
+    Header header;
+    if (!in.scalar(header) ||
+        header.magic != expected.magic ||
+        header.format_version != expected.format_version ||
+        std::memcmp(header.interpreter_version, expected.interpreter_version,
+                    sizeof(header.interpreter_version)) != 0 ||
+        header.source_hash != expected.source_hash ||
+        header.source_size != expected.source_size ||
+        header.payload_hash != ScriptCache::hash(in.rest())) {
+        return false;
+    }
+
+    // Corrupt counts must not size allocations beyond what the file holds
+    if (header.node_count > in.remaining() / sizeof(ASTNode) ||
+        header.statement_count > in.remaining() / sizeof(NodeIndex) ||
+        header.name_count > in.remaining() / sizeof(uint32_t) ||
+        header.slot_name_count > in.remaining() / sizeof(uint32_t)) {
+        return false;
+    }
+    program.nodes.resize(header.node_count, ASTNode(ASTNodeType::LITERAL));
+    if (!in.bytes(program.nodes.data(), header.node_count * sizeof(ASTNode))) {
+        return false;
+    }
+
+    program.positions.reserve(header.node_count);
+    for (uint32_t i = 0; i < header.node_count; ++i) {
+        int32_t line, column;
+        if (!in.scalar(line) || !in.scalar(column)) {
+            return false;
+        }
+        program.positions.emplace_back(file_id, line, column);
+    }
+
+    program.statements.resize(header.statement_count);
+    if (!in.bytes(program.statements.data(), header.statement_count * sizeof(NodeIndex))) {
+        return false;
+    }
+
+    // The pool was deduplicated when it was written, so adding the values
+    // back in order reproduces the same indices
+    for (uint32_t i = 0; i < header.constant_count; ++i) {
+        Value value;
+        if (!in.value(value) || program.constants.add(value) != i) {
+            return false;
+        }
+    }
+
+    program.names.resize(header.name_count);
+    for (std::string& name : program.names) {
+        if (!in.text(name)) {
+            return false;
+        }
+    }
+    program.slot_names.resize(header.slot_name_count);
+    for (std::string& name : program.slot_names) {
+        if (!in.text(name)) {
+            return false;
+        }
+    }
+
+    program.binary_sites = header.binary_sites;
+    return in.atEnd();
+}
+
+} // namespace
+
+uint64_t ScriptCache::hash(std::string_view text) {
+    // Multiply-rotate over 8-byte words; only has to tell versions of one
+    // script apart, and must stay far cheaper than lexing them
+    constexpr uint64_t MULTIPLIER = 0x9E3779B97F4A7C15ULL;
+    uint64_t h = 0xCBF29CE484222325ULL ^ text.size();
+    const char* data = text.data();
+    size_t remaining = text.size();
+
+    while (remaining >= 8) {
+        uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        h = (h ^ word) * MULTIPLIER;
+        h ^= h >> 29;
+        data += 8;
+        remaining -= 8;
+    }
+    uint64_t tail = 0;
+    if (remaining > 0) {
+        std::memcpy(&tail, data, remaining);
+    }
+    h = (h ^ tail) * MULTIPLIER;
+    h ^= h >> 32;
+    return h;
+}
+
+std::string ScriptCache::pathFor(const std::string& script_path) {
+    // foo.lz -> foo.lzc
+    const char* dir = std::getenv("LIZARD_CACHE_DIR");
+    if (!dir || !*dir) {
+        return script_path + "c";
+    }
+
+    // One flat directory for every script, so the name also carries a hash
+    // of the script's absolute path
+    char resolved[PATH_MAX];
+    std::string absolute = realpath(script_path.c_str(), resolved) ? resolved : script_path;
+    size_t slash = absolute.rfind('/');
+    std::string base = slash == std::string::npos ? absolute : absolute.substr(slash + 1);
+
+    char suffix[24];
+    std::snprintf(suffix, sizeof(suffix), "-%016llx",
+                  static_cast<unsigned long long>(hash(absolute)));
+    return std::string(dir) + "/" + base.substr(0, base.length() - 3) + suffix + ".lzc";
+}
+
+std::unique_ptr<Program> ScriptCache::load(const SourceFile& source, uint32_t file_id) {
+    MappedImage image(pathFor(source.filename()));
+    if (!image.valid()) {
+        return nullptr;
+    }
+
+    auto program = std::make_unique<Program>();
+    ImageReader in = image.reader();
+    if (!readEntry(in, makeHeader(source), file_id, *program)) {
+        return nullptr;
+    }
+    return program;
+}
+
+void ScriptCache::store(const Program& program, const SourceFile& source) {
+    Header header = makeHeader(source);
+    header.node_count = static_cast<uint32_t>(program.nodes.size());
+    header.statement_count = static_cast<uint32_t>(program.statements.size());
+    header.constant_count = static_cast<uint32_t>(program.constants.size());
+    header.name_count = static_cast<uint32_t>(program.names.size());
+    header.slot_name_count = static_cast<uint32_t>(program.slot_names.size());
+    header.binary_sites = program.binary_sites;
+
+    ImageWriter payload;
+    payload.bytes(program.nodes.data(), program.nodes.size() * sizeof(ASTNode));
+    for (const Position& pos : program.positions) {
+        payload.scalar(static_cast<int32_t>(pos.line));
+        payload.scalar(static_cast<int32_t>(pos.column));
+    }
+    payload.bytes(program.statements.data(), program.statements.size() * sizeof(NodeIndex));
+    for (const Value& value : program.constants.all()) {
+        payload.value(value);
+    }
+    for (const std::string& name : program.names) {
+        payload.text(name);
+    }
+    for (const std::string& name : program.slot_names) {
+        payload.text(name);
+    }
+    header.payload_hash = hash(payload.data());
+
+    ImageWriter out;
+    out.scalar(header);
+    out.bytes(payload.data().data(), payload.data().size());
+    out.commit(pathFor(source.filename()));
+}
+
+} // namespace Lizard
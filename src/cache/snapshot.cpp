@@ -0,0 +1,141 @@
+#include "snapshot.h"
+#include "binary_image.h"
+#include "source_manager.h"
+#include <cstring>
+
+// Set by the build system from the project version
+#ifndef LIZARD_VERSION
+#define LIZARD_VERSION "unknown"
+#endif
+
+namespace Lizard {
+
+namespace {
+
+// Also tells the byte order apart, since snapshots are in native order
+constexpr uint32_t MAGIC = 0x535A4C7F; // "\x7FLZS" little-endian
+
+struct Header {
+    uint32_t magic;
+    uint32_t format_version;
+    char interpreter_version[16];
+    uint32_t variable_count;
+};
+
+enum VariableFlags : uint8_t {
+    DEFINED = 1,
+    CONSTANT = 2,
+    INITIALIZED = 4
+};
+
+Header makeHeader() {
+    Header header{};
+    header.magic = MAGIC;
+    header.format_version = Snapshot::FORMAT_VERSION;
+    std::strncpy(header.interpreter_version, LIZARD_VERSION, sizeof(header.interpreter_version) - 1);
+    return header;
+}
+
+} // namespace
+
+bool Snapshot::save(const std::string& path, const std::vector<std::string>& slot_names,
+                    const Environment& environment) {
+    const std::vector<Variable>& slots = environment.slots();
+    Header header = makeHeader();
+    header.variable_count = static_cast<uint32_t>(slots.size());
+
+    ImageWriter out;
+    out.scalar(header);
+
+    // Declarations can come from earlier snapshots, so files are stored by
+    // name in a table of their own
+    std::vector<std::string> files;
+    std::vector<uint32_t> file_indices;
+    for (const Variable& var : slots) {
+        const std::string& filename = var.declaration_position.filename();
+        uint32_t index = 0;
+        while (index < files.size() && files[index] != filename) {
+            index++;
+        }
+        if (index == files.size()) {
+            files.push_back(filename);
+        }
+        file_indices.push_back(index);
+    }
+    out.scalar(static_cast<uint32_t>(files.size()));
+    for (const std::string& filename : files) {
+        out.text(filename);
+    }
+
+    for (size_t i = 0; i < slots.size(); ++i) {
+        const Variable& var = slots[i];
+        uint8_t flags = (var.is_defined ? DEFINED : 0) |
+                        (var.is_constant ? CONSTANT : 0) |
+                        (var.is_initialized ? INITIALIZED : 0);
+        out.text(slot_names[i]);
+        out.scalar(flags);
+        out.scalar(file_indices[i]);
+        out.scalar(static_cast<int32_t>(var.declaration_position.line));
+        out.scalar(static_cast<int32_t>(var.declaration_position.column));
+        out.value(var.value);
+    }
+
+    return out.commit(path);
+}
+
+std::unique_ptr<Snapshot> Snapshot::load(const std::string& path) {
+    MappedImage image(path);
+    if (!image.valid()) {
+        return nullptr;
+    }
+    ImageReader in = image.reader();
+
+    Header expected = makeHeader();
+    Header header;
+    uint32_t file_count;
+    if (!in.scalar(header) ||
+        header.magic != expected.magic ||
+        header.format_version != expected.format_version ||
+        std::memcmp(header.interpreter_version, expected.interpreter_version,
+                    sizeof(header.interpreter_version)) != 0 ||
+        !in.scalar(file_count) ||
+        file_count > in.remaining() / sizeof(uint32_t) ||
+        header.variable_count > in.remaining() / sizeof(uint32_t)) {
+        return nullptr;
+    }
+
+    std::vector<uint32_t> file_ids;
+    for (uint32_t i = 0; i < file_count; ++i) {
+        std::string filename;
+        if (!in.text(filename)) {
+            return nullptr;
+        }
+        file_ids.push_back(SourceManager::addFile(filename));
+    }
+
+    auto snapshot = std::make_unique<Snapshot>();
+    snapshot->names.resize(header.variable_count);
+    snapshot->variables.resize(header.variable_count);
+    for (uint32_t i = 0; i < header.variable_count; ++i) {
+        Variable& var = snapshot->variables[i];
+        uint8_t flags;
+        uint32_t file_index;
+        int32_t line, column;
+        if (!in.text(snapshot->names[i]) || !in.scalar(flags) || !in.scalar(file_index) ||
+            file_index >= file_ids.size() || !in.scalar(line) || !in.scalar(column) ||
+            !in.value(var.value)) {
+            return nullptr;
+        }
+        var.is_defined = (flags & DEFINED) != 0;
+        var.is_constant = (flags & CONSTANT) != 0;
+        var.is_initialized = (flags & INITIALIZED) != 0;
+        var.declaration_position = Position(file_ids[file_index], line, column);
+    }
+
+    if (!in.atEnd()) {
+        return nullptr;
+    }
+    return snapshot;
+}
+
+} // namespace Lizard
@@ -0,0 +1,122 @@
+#include "compiler.h"
+#include "error_handler.h"
+
+namespace Lizard {
+
+Chunk Compiler::compile(const Program& program) {
+    this->program = &program;
+    chunk = Chunk();
+    chunk.constants = program.constants.all();
+    chunk.names = program.slot_names;
+
+    for (NodeIndex stmt : program.statements) {
+        next_register = 0;
+        compileStatement(stmt);
+    }
+
+    return std::move(chunk);
+}
+
+void Compiler::compileStatement(NodeIndex index) {
+    const ASTNode& node = (*program)[index];
+    const Position& pos = program->position(index);
+    switch (node.type) {
+        case ASTNodeType::VARIABLE_DECLARATION:
+            compileVariableDeclaration(node, pos);
+            break;
+        case ASTNodeType::VARIABLE_ASSIGNMENT:
+            compileVariableAssignment(node, pos);
+            break;
+        case ASTNodeType::PRINT_STATEMENT:
+            compilePrintStatement(node, pos);
+            break;
+        default:
+            ErrorHandler::reportError("Unknown statement type", pos);
+    }
+}
+
+void Compiler::compileVariableDeclaration(const ASTNode& node, const Position& pos) {
+    uint32_t slot = (*program)[node.target()].slot();
+    uint32_t is_constant = node.isConstant() ? 1 : 0;
+
+    if (node.value() != NO_NODE) {
+        uint16_t value = compileExpression(node.value());
+        chunk.emit(Instruction(OpCode::DEFINE_VAR, value, slot, is_constant), pos);
+    } else {
+        chunk.emit(Instruction(OpCode::DECLARE_VAR, 0, slot, is_constant), pos);
+    }
+}
+
+void Compiler::compileVariableAssignment(const ASTNode& node, const Position& pos) {
+    uint16_t value = compileExpression(node.value());
+    chunk.emit(Instruction(OpCode::SET_VAR, value, (*program)[node.target()].slot()), pos);
+}
+
+void Compiler::compilePrintStatement(const ASTNode& node, const Position& pos) {
+    uint16_t value = compileExpression(node.expression());
+    chunk.emit(Instruction(OpCode::PRINT, value), pos);
+}
+
+uint16_t Compiler::compileExpression(NodeIndex index) {
+    const ASTNode& node = (*program)[index];
+    const Position& pos = program->position(index);
+    switch (node.type) {
+        case ASTNodeType::LITERAL:
+            return compileLiteral(node, pos);
+        case ASTNodeType::IDENTIFIER:
+            return compileIdentifier(node, pos);
+        case ASTNodeType::BINARY_EXPRESSION:
+            return compileBinaryExpression(node, pos);
+        default:
+            ErrorHandler::reportError("Unknown expression type", pos);
+    }
+    return 0;
+}
+
+uint16_t Compiler::compileLiteral(const ASTNode& node, const Position& pos) {
+    uint16_t dst = allocateRegister(pos);
+    chunk.emit(Instruction(OpCode::LOAD_CONST, dst, node.constant()), pos);
+    return dst;
+}
+
+uint16_t Compiler::compileIdentifier(const ASTNode& node, const Position& pos) {
+    uint16_t dst = allocateRegister(pos);
+    chunk.emit(Instruction(OpCode::GET_VAR, dst, node.slot()), pos);
+    return dst;
+}
+
+uint16_t Compiler::compileBinaryExpression(const ASTNode& node, const Position& pos) {
+    uint16_t left = compileExpression(node.left());
+    uint16_t right = compileExpression(node.right());
+
+    OpCode op = OpCode::ADD;
+    switch (node.op) {
+        case BinaryOperator::ADD:      op = OpCode::ADD; break;
+        case BinaryOperator::SUBTRACT: op = OpCode::SUBTRACT; break;
+        case BinaryOperator::MULTIPLY: op = OpCode::MULTIPLY; break;
+        case BinaryOperator::DIVIDE:   op = OpCode::DIVIDE; break;
+        case BinaryOperator::INT_DIV:  op = OpCode::INT_DIV; break;
+        case BinaryOperator::MODULO:   op = OpCode::MODULO; break;
+    }
+
+    // The result reuses the left operand's register; everything above it is free again
+    Instruction instruction(op, left, left, right);
+    instruction.types = node.operand_types;
+    chunk.emit(instruction, pos);
+    next_register = left + 1;
+    return left;
+}
+
+uint16_t Compiler::allocateRegister(const Position& pos) {
+    if (next_register == UINT16_MAX) {
+        ErrorHandler::reportError("Expression is too deeply nested", pos);
+    }
+
+    uint16_t reg = next_register++;
+    if (next_register > chunk.register_count) {
+        chunk.register_count = next_register;
+    }
+    return reg;
+}
+
+} // namespace Lizard
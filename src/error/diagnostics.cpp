@@ -0,0 +1,40 @@
+#include "diagnostics.h"
+#include <algorithm>
+
+namespace Lizard {
+
+void Diagnostics::report(const std::string& message, const Position& pos) {
+    if (limitReached()) {
+        return;
+    }
+    for (const LizardError& error : errors) {
+        const Position& seen = error.position;
+        if (seen.file == pos.file && seen.line == pos.line && seen.column == pos.column) {
+            return;
+        }
+    }
+    errors.emplace_back(message, pos);
+}
+
+void Diagnostics::print(std::ostream& out) const {
+    // The lexer runs ahead of the parser, so reports arrive out of order
+    std::vector<const LizardError*> sorted;
+    for (const LizardError& error : errors) {
+        sorted.push_back(&error);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [](const LizardError* a, const LizardError* b) {
+        const Position& left = a->position;
+        const Position& right = b->position;
+        return left.line != right.line ? left.line < right.line : left.column < right.column;
+    });
+    
+    for (const LizardError* error : sorted) {
+        out << error->formatError() << std::endl;
+    }
+    
+    if (limitReached()) {
+        out << "Too many errors (" << limit << "), stopping." << std::endl;
+    }
+}
+
+} // namespace Lizard
@@ -1,37 +1,42 @@
 #include "error_handler.h"
+#include "source_manager.h"
 #include <sstream>
 #include <iostream>
 
 namespace Lizard {
 
-std::string ErrorHandler::current_filename;
-std::vector<std::string> ErrorHandler::source_lines;
+namespace {
+
+// Spaces under the "N | " gutter of an excerpt of line `line`, then a caret
+// under `column`
+std::string caretLine(int line, int column) {
+    std::string pointer_line(std::to_string(line).length() + 3, ' ');
+    for (int i = 1; i < column; ++i) {
+        pointer_line += " ";
+    }
+    return pointer_line + "^";
+}
+
+} // namespace
 
 LizardError::LizardError(const std::string& message, const Position& pos)
-    : std::runtime_error(message), position(pos), error_message(message) {}
+    : std::runtime_error(message), position(pos), error_message(message),
+      source(SourceManager::sharedFile(pos.file)) {}
 
 void LizardError::addNote(const std::string& note, const Position& note_pos) {
     notes.emplace_back(note_pos, note);
 }
 
-void LizardError::setSourceLines(const std::vector<std::string>& lines) {
-    source_lines = lines;
-}
-
 std::string LizardError::formatError() const {
     std::ostringstream oss;
     
-    oss << "\033[1;31m" << position.filename << " (Line " << position.line << ", Column " << position.column << "): Error: " << "\033[0m" << error_message << "\n\n";
+    oss << "\033[1;31m" << position.filename() << " (Line " << position.line << ", Column " << position.column << "): Error: " << "\033[0m" << error_message << "\n\n";
 
-    if (!source_lines.empty() && position.line > 0 && position.line <= (int)source_lines.size()) {
-        std::string line = source_lines[position.line - 1];
+    if (source && position.line > 0 && position.line <= (int)source->lineCount()) {
+        std::string_view line = source->line(position.line);
         oss << position.line << " | " << line << "\n";
 
-        std::string pointer_line = std::string(std::to_string(position.line).length() + 3, ' ');
-        for (int i = 1; i < position.column; ++i) {
-            pointer_line += " ";
-        }
-        pointer_line += "^";
+        std::string pointer_line = caretLine(position.line, position.column);
 
         size_t start_col = position.column - 1;
         size_t end_col = start_col;
@@ -49,29 +54,30 @@ std::string LizardError::formatError() const {
 
     for (const auto& note : notes) {
         oss << "\033[34m" << "~ Note: " << "\033[0m" << note.second << "\n";
-        if (note.first.line > 0 && !source_lines.empty() && note.first.line <= (int)source_lines.size()) {
-            oss << "\n" << note.first.line << " | " << source_lines[note.first.line - 1] << "\n";
+        if (note.first.line <= 0) {
+            continue;
+        }
+        const SourceFile* note_source = SourceManager::loadFile(note.first.file);
+        if (note_source && note.first.line <= (int)note_source->lineCount()) {
+            oss << "\n" << note.first.line << " | " << note_source->line(note.first.line) << "\n";
+            oss << caretLine(note.first.line, note.first.column) << "\n";
+        } else if (note.first.file != 0) {
+            // The file is gone or unreadable; its name still says where
+            oss << "\n" << note.first.filename() << ":" << note.first.line << "\n";
         }
     }
     
     return oss.str();
 }
 
-void ErrorHandler::setSourceFile(const std::string& filename, const std::vector<std::string>& lines) {
-    current_filename = filename;
-    source_lines = lines;
-}
-
 void ErrorHandler::reportError(const std::string& message, const Position& pos) {
     LizardError error(message, pos);
-    error.setSourceLines(source_lines);
     throw error;
 }
 
 void ErrorHandler::reportErrorWithNote(const std::string& message, const Position& pos, 
                                      const std::string& note, const Position& note_pos) {
     LizardError error(message, pos);
-    error.setSourceLines(source_lines);
     error.addNote(note, note_pos);
     throw error;
 }
@@ -1,161 +1,266 @@
 #include "eval_arithmetic.h"
 #include "error_handler.h"
+#include <array>
 #include <cmath>
+#include <utility>
 
 namespace Lizard {
 
-Value ArithmeticEvaluator::evaluateBinaryExpression(const BinaryExpression& node, 
-                                                   const Value& left, const Value& right) {
-    switch (node.operator_) {
-        case BinaryOperator::ADD:
-            return add(left, right, node.position);
-        case BinaryOperator::SUBTRACT:
-            return subtract(left, right, node.position);
-        case BinaryOperator::MULTIPLY:
-            return multiply(left, right, node.position);
-        case BinaryOperator::DIVIDE:
-            return divide(left, right, node.position);
-        case BinaryOperator::INT_DIV:
-            return integerDivide(left, right, node.position);
-        case BinaryOperator::MODULO:
-            return modulo(left, right, node.position);
-        default:
-            ErrorHandler::reportError("Unknown binary operator", node.position);
-            return Value(nullptr);
+namespace {
+
+using Kernel = Value (*)(const Value& left, const Value& right, const Position& pos);
+
+constexpr size_t OPERATOR_COUNT = static_cast<size_t>(BinaryOperator::MODULO) + 1;
+constexpr size_t TYPE_COUNT = static_cast<size_t>(ValueType::NIL) + 1;
+
+// Per-type facts the kernels are generated from. A new ValueType needs a
+// specialization here; numeric types also provide toDouble().
+template<ValueType T> struct TypeTraits;
+
+template<> struct TypeTraits<ValueType::STRING> {
+    static constexpr const char* name = "string";
+    static constexpr bool numeric = false;
+};
+
+template<> struct TypeTraits<ValueType::INTEGER> {
+    static constexpr const char* name = "integer";
+    static constexpr bool numeric = true;
+    static double toDouble(const Value& value) {
+        return value.isBigInteger() ? value.asBigInt().toDouble()
+                                    : static_cast<double>(value.get<int64_t>());
     }
-}
+};
 
-Value ArithmeticEvaluator::add(const Value& left, const Value& right, const Position& pos) {
-    // String concatenation
-    if (left.getType() == ValueType::STRING || right.getType() == ValueType::STRING) {
-        return Value(left.toString() + right.toString());
+template<> struct TypeTraits<ValueType::FLOAT> {
+    static constexpr const char* name = "float";
+    static constexpr bool numeric = true;
+    static double toDouble(const Value& value) { return value.get<double>(); }
+};
+
+template<> struct TypeTraits<ValueType::BOOLEAN> {
+    static constexpr const char* name = "boolean";
+    static constexpr bool numeric = false;
+};
+
+template<> struct TypeTraits<ValueType::NIL> {
+    static constexpr const char* name = "nil";
+    static constexpr bool numeric = false;
+};
+
+// Per-operator arithmetic. integer() tries the int64 fast path and reports
+// overflow by returning false; big() is the BigInt fallback.
+template<BinaryOperator Op> struct OperatorTraits;
+
+template<> struct OperatorTraits<BinaryOperator::ADD> {
+    static bool integer(int64_t a, int64_t b, int64_t& result) { return !__builtin_add_overflow(a, b, &result); }
+    static BigInt big(const BigInt& a, const BigInt& b) { return BigInt::add(a, b); }
+    static double floating(double a, double b) { return a + b; }
+    static std::string typeError(const char* left, const char* right) {
+        return std::string("Cannot add ") + left + " and " + right;
     }
-    
-    // Numeric addition
-    if (!isNumeric(left) || !isNumeric(right)) {
-        ErrorHandler::reportError("Cannot add " + getTypeName(left) + " and " + getTypeName(right), pos);
+};
+
+template<> struct OperatorTraits<BinaryOperator::SUBTRACT> {
+    static bool integer(int64_t a, int64_t b, int64_t& result) { return !__builtin_sub_overflow(a, b, &result); }
+    static BigInt big(const BigInt& a, const BigInt& b) { return BigInt::subtract(a, b); }
+    static double floating(double a, double b) { return a - b; }
+    static std::string typeError(const char* left, const char* right) {
+        return std::string("Cannot subtract ") + right + " from " + left;
     }
-    
-    // If either is float, result is float
-    if (left.getType() == ValueType::FLOAT || right.getType() == ValueType::FLOAT) {
-        return Value(toDouble(left) + toDouble(right));
+};
+
+template<> struct OperatorTraits<BinaryOperator::MULTIPLY> {
+    static bool integer(int64_t a, int64_t b, int64_t& result) { return !__builtin_mul_overflow(a, b, &result); }
+    static BigInt big(const BigInt& a, const BigInt& b) { return BigInt::multiply(a, b); }
+    static double floating(double a, double b) { return a * b; }
+    static std::string typeError(const char* left, const char* right) {
+        return std::string("Cannot multiply ") + left + " and " + right;
     }
-    
-    // Both integers
-    return Value(toInt(left) + toInt(right));
-}
+};
 
-Value ArithmeticEvaluator::subtract(const Value& left, const Value& right, const Position& pos) {
-    if (!isNumeric(left) || !isNumeric(right)) {
-        ErrorHandler::reportError("Cannot subtract " + getTypeName(right) + " from " + getTypeName(left), pos);
+template<> struct OperatorTraits<BinaryOperator::DIVIDE> {
+    static std::string typeError(const char* left, const char* right) {
+        return std::string("Cannot divide ") + left + " by " + right;
     }
-    
-    // If either is float, result is float
-    if (left.getType() == ValueType::FLOAT || right.getType() == ValueType::FLOAT) {
-        return Value(toDouble(left) - toDouble(right));
+};
+
+// Immediates are 48-bit, so neither quotient nor remainder can overflow
+template<> struct OperatorTraits<BinaryOperator::INT_DIV> {
+    static constexpr const char* zeroError = "Division by zero";
+    static constexpr const char* nonFiniteError = "Cannot perform integer division on a non-finite float";
+    static int64_t integer(int64_t a, int64_t b) { return a / b; }
+    static BigInt big(const BigInt& a, const BigInt& b) { return BigInt::divide(a, b); }
+    static std::string typeError(const char* left, const char* right) {
+        return std::string("Cannot perform integer division on ") + left + " and " + right;
     }
-    
-    // Both integers
-    return Value(toInt(left) - toInt(right));
+};
+
+template<> struct OperatorTraits<BinaryOperator::MODULO> {
+    static constexpr const char* zeroError = "Modulo by zero";
+    static constexpr const char* nonFiniteError = "Cannot perform modulo on a non-finite float";
+    static int64_t integer(int64_t a, int64_t b) { return a % b; }
+    static BigInt big(const BigInt& a, const BigInt& b) { return BigInt::remainder(a, b); }
+    static std::string typeError(const char* left, const char* right) {
+        return std::string("Cannot perform modulo on ") + left + " and " + right;
+    }
+};
+
+constexpr bool isTruncating(BinaryOperator op) {
+    return op == BinaryOperator::INT_DIV || op == BinaryOperator::MODULO;
 }
 
-Value ArithmeticEvaluator::multiply(const Value& left, const Value& right, const Position& pos) {
-    if (!isNumeric(left) || !isNumeric(right)) {
-        ErrorHandler::reportError("Cannot multiply " + getTypeName(left) + " and " + getTypeName(right), pos);
+// Truncates a finite float to an integer Value; integers pass through
+Value toInteger(const Value& value) {
+    if (value.isFloat()) {
+        return Value(BigInt::fromDouble(value.get<double>()));
     }
-    
-    // If either is float, result is float
-    if (left.getType() == ValueType::FLOAT || right.getType() == ValueType::FLOAT) {
-        return Value(toDouble(left) * toDouble(right));
+    return value;
+}
+
+bool isFinite(const Value& value) {
+    return !value.isFloat() || std::isfinite(value.get<double>());
+}
+
+// Big integers are never zero; results that fit are stored as immediates
+bool isZeroInteger(const Value& value) {
+    return value.isSmallInteger() && value.get<int64_t>() == 0;
+}
+
+template<BinaryOperator Op, ValueType L, ValueType R>
+Value typeErrorKernel(const Value&, const Value&, const Position& pos) {
+    ErrorHandler::reportError(OperatorTraits<Op>::typeError(TypeTraits<L>::name, TypeTraits<R>::name), pos);
+}
+
+Value concatenateKernel(const Value& left, const Value& right, const Position&) {
+    std::string result;
+    if (left.isString() && right.isString()) {
+        result.reserve(left.asString().size() + right.asString().size());
     }
-    
-    // Both integers
-    return Value(toInt(left) * toInt(right));
+    left.appendTo(result);
+    right.appendTo(result);
+    return Value(std::move(result));
 }
 
-Value ArithmeticEvaluator::divide(const Value& left, const Value& right, const Position& pos) {
-    if (!isNumeric(left) || !isNumeric(right)) {
-        ErrorHandler::reportError("Cannot divide " + getTypeName(left) + " by " + getTypeName(right), pos);
+// +, - and * on two integers
+template<BinaryOperator Op>
+Value integerKernel(const Value& left, const Value& right, const Position&) {
+    int64_t result;
+    if (left.isSmallInteger() && right.isSmallInteger() &&
+        OperatorTraits<Op>::integer(left.get<int64_t>(), right.get<int64_t>(), result)) {
+        return Value(result);
     }
-    
-    double right_val = toDouble(right);
-    if (right_val == 0.0) {
+    // Overflowed, or at least one side is big
+    return Value(OperatorTraits<Op>::big(left.toBigInt(), right.toBigInt()));
+}
+
+// +, - and * with at least one float operand
+template<BinaryOperator Op, ValueType L, ValueType R>
+Value floatKernel(const Value& left, const Value& right, const Position&) {
+    return Value(OperatorTraits<Op>::floating(TypeTraits<L>::toDouble(left), TypeTraits<R>::toDouble(right)));
+}
+
+// '/' always produces a float
+template<ValueType L, ValueType R>
+Value divideKernel(const Value& left, const Value& right, const Position& pos) {
+    double divisor = TypeTraits<R>::toDouble(right);
+    if (divisor == 0.0) {
         ErrorHandler::reportError("Division by zero", pos);
     }
-    
-    // Division always returns float
-    return Value(toDouble(left) / right_val);
+    return Value(TypeTraits<L>::toDouble(left) / divisor);
 }
 
-Value ArithmeticEvaluator::integerDivide(const Value& left, const Value& right, const Position& pos) {
-    if (!isNumeric(left) || !isNumeric(right)) {
-        ErrorHandler::reportError("Cannot perform integer division on " + getTypeName(left) + " and " + getTypeName(right), pos);
+// '//' and '%' always produce an integer; float operands are truncated first
+template<BinaryOperator Op, ValueType L, ValueType R>
+Value truncatingKernel(const Value& left, const Value& right, const Position& pos) {
+    if constexpr (L == ValueType::FLOAT || R == ValueType::FLOAT) {
+        if (!isFinite(left) || !isFinite(right)) {
+            ErrorHandler::reportError(OperatorTraits<Op>::nonFiniteError, pos);
+        }
     }
     
-    int right_val = toInt(right);
-    if (right_val == 0) {
-        ErrorHandler::reportError("Division by zero", pos);
+    Value dividend = toInteger(left);
+    Value divisor = toInteger(right);
+    if (isZeroInteger(divisor)) {
+        ErrorHandler::reportError(OperatorTraits<Op>::zeroError, pos);
     }
     
-    // Integer division always returns integer
-    return Value(toInt(left) / right_val);
+    if (dividend.isSmallInteger() && divisor.isSmallInteger()) {
+        return Value(OperatorTraits<Op>::integer(dividend.get<int64_t>(), divisor.get<int64_t>()));
+    }
+    return Value(OperatorTraits<Op>::big(dividend.toBigInt(), divisor.toBigInt()));
 }
 
-Value ArithmeticEvaluator::modulo(const Value& left, const Value& right, const Position& pos) {
-    if (!isNumeric(left) || !isNumeric(right)) {
-        ErrorHandler::reportError("Cannot perform modulo on " + getTypeName(left) + " and " + getTypeName(right), pos);
-    }
+template<BinaryOperator Op, ValueType L, ValueType R>
+constexpr Kernel selectKernel() {
+    constexpr bool numeric = TypeTraits<L>::numeric && TypeTraits<R>::numeric;
     
-    int right_val = toInt(right);
-    if (right_val == 0) {
-        ErrorHandler::reportError("Modulo by zero", pos);
+    if constexpr (Op == BinaryOperator::ADD && (L == ValueType::STRING || R == ValueType::STRING)) {
+        return concatenateKernel;
+    } else if constexpr (!numeric) {
+        return typeErrorKernel<Op, L, R>;
+    } else if constexpr (Op == BinaryOperator::DIVIDE) {
+        return divideKernel<L, R>;
+    } else if constexpr (isTruncating(Op)) {
+        return truncatingKernel<Op, L, R>;
+    } else if constexpr (L == ValueType::INTEGER && R == ValueType::INTEGER) {
+        return integerKernel<Op>;
+    } else {
+        return floatKernel<Op, L, R>;
     }
-    
-    // Modulo always returns integer
-    return Value(toInt(left) % right_val);
 }
 
-bool ArithmeticEvaluator::isNumeric(const Value& value) {
-    ValueType type = value.getType();
-    return type == ValueType::INTEGER || type == ValueType::FLOAT;
+constexpr size_t kernelIndex(BinaryOperator op, ValueType left, ValueType right) {
+    return (static_cast<size_t>(op) * TYPE_COUNT + static_cast<size_t>(left)) * TYPE_COUNT +
+           static_cast<size_t>(right);
 }
 
-double ArithmeticEvaluator::toDouble(const Value& value) {
-    switch (value.getType()) {
-        case ValueType::INTEGER:
-            return static_cast<double>(std::get<int>(value.data));
-        case ValueType::FLOAT:
-            return std::get<double>(value.data);
-        default:
-            return 0.0; // Should never reach here if isNumeric check is done
-    }
+template<size_t... Index>
+constexpr std::array<Kernel, sizeof...(Index)> makeKernelTable(std::index_sequence<Index...>) {
+    return {{ selectKernel<static_cast<BinaryOperator>(Index / (TYPE_COUNT * TYPE_COUNT)),
+                           static_cast<ValueType>(Index / TYPE_COUNT % TYPE_COUNT),
+                           static_cast<ValueType>(Index % TYPE_COUNT)>()... }};
 }
 
-int ArithmeticEvaluator::toInt(const Value& value) {
-    switch (value.getType()) {
-        case ValueType::INTEGER:
-            return std::get<int>(value.data);
-        case ValueType::FLOAT:
-            return static_cast<int>(std::get<double>(value.data));
-        default:
-            return 0; // Should never reach here if isNumeric check is done
-    }
-}
-
-std::string ArithmeticEvaluator::getTypeName(const Value& value) {
-    switch (value.getType()) {
-        case ValueType::STRING:
-            return "string";
-        case ValueType::INTEGER:
-            return "integer";
-        case ValueType::FLOAT:
-            return "float";
-        case ValueType::BOOLEAN:
-            return "boolean";
-        case ValueType::NIL:
-            return "nil";
+constexpr auto KERNELS = makeKernelTable(std::make_index_sequence<OPERATOR_COUNT * TYPE_COUNT * TYPE_COUNT>());
+
+bool isNumeric(const Value& value) {
+    return value.isInteger() || value.isFloat();
+}
+
+double toDouble(const Value& value) {
+    return value.isFloat() ? value.get<double>() : TypeTraits<ValueType::INTEGER>::toDouble(value);
+}
+
+} // namespace
+
+Value ArithmeticEvaluator::evaluate(BinaryOperator op, const Value& left, const Value& right,
+                                    const Position& pos) {
+    return KERNELS[kernelIndex(op, left.getType(), right.getType())](left, right, pos);
+}
+
+Value ArithmeticEvaluator::evaluate(BinaryOperator op, TypePair types, const Value& left,
+                                    const Value& right, const Position& pos) {
+    return KERNELS[kernelIndex(op, types.left(), types.right())](left, right, pos);
+}
+
+bool ArithmeticEvaluator::canEvaluate(BinaryOperator op, const Value& left, const Value& right) {
+    if (op == BinaryOperator::ADD && (left.isString() || right.isString())) {
+        return true;
+    }
+    
+    if (!isNumeric(left) || !isNumeric(right)) {
+        return false;
+    }
+    
+    switch (op) {
+        case BinaryOperator::DIVIDE:
+            return toDouble(right) != 0.0;
+        case BinaryOperator::INT_DIV:
+        case BinaryOperator::MODULO:
+            return isFinite(left) && isFinite(right) && !isZeroInteger(toInteger(right));
         default:
-            return "unknown";
+            return true;
     }
 }
-}
\ No newline at end of file
+
+} // namespace Lizard
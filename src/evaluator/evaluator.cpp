@@ -1,106 +1,96 @@
 #include "evaluator.h"
 #include "eval_arithmetic.h"
 #include "error_handler.h"
-#include <iostream>
 
 namespace Lizard {
 
-Evaluator::Evaluator() {}
+Evaluator::Evaluator(OutputBuffer& output) : output(output) {}
 
 void Evaluator::evaluate(const Program& program) {
-    for (const auto& stmt : program.statements) {
-        executeStatement(*stmt);
+    this->program = &program;
+    environment.reset(program.slot_names, prelude);
+    sites.assign(program.binary_sites, BinarySite());
+
+    for (NodeIndex stmt : program.statements) {
+        executeStatement(stmt);
     }
 }
 
-void Evaluator::executeStatement(const ASTNode& node) {
+void Evaluator::execute(const Program& program, NodeIndex statement) {
+    this->program = &program;
+    environment.grow(program.slot_names);
+    sites.assign(program.binary_sites, BinarySite());
+    executeStatement(statement);
+}
+
+void Evaluator::executeStatement(NodeIndex index) {
+    const ASTNode& node = (*program)[index];
     switch (node.type) {
         case ASTNodeType::VARIABLE_DECLARATION:
-            executeVariableDeclaration(static_cast<const VariableDeclaration&>(node));
+            executeVariableDeclaration(node, program->position(index));
             break;
         case ASTNodeType::VARIABLE_ASSIGNMENT:
-            executeVariableAssignment(static_cast<const VariableAssignment&>(node));
+            executeVariableAssignment(node, program->position(index));
             break;
         case ASTNodeType::PRINT_STATEMENT:
-            executePrintStatement(static_cast<const PrintStatement&>(node));
+            executePrintStatement(node);
             break;
         default:
-            ErrorHandler::reportError("Unknown statement type", node.position);
+            ErrorHandler::reportError("Unknown statement type", program->position(index));
     }
 }
 
-void Evaluator::executeVariableDeclaration(const VariableDeclaration& node) {
-    Value value(nullptr); // Default to nil
-    
-    if (node.value) {
-        value = evaluateExpression(*node.value);
-        environment.define(node.name, value, node.is_constant, node.position);
+void Evaluator::executeVariableDeclaration(const ASTNode& node, const Position& pos) {
+    uint32_t slot = (*program)[node.target()].slot();
+    if (node.value() != NO_NODE) {
+        Value value = evaluateExpression(node.value());
+        environment.define(slot, value, node.isConstant(), true, pos);
     } else {
-        // Late initialization - store uninitialized variable
-        Variable uninit_var(value, node.is_constant, false, node.position);
-        if (environment.exists(node.name)) {
-            ErrorHandler::reportError("Variable '" + node.name + "' is already defined", node.position);
-        }
-        environment.define(node.name, value, node.is_constant, node.position);
-        // Mark as uninitialized
-        Variable* var = environment.getVariable(node.name);
-        if (var) {
-            var->is_initialized = false;
-        }
+        // Late initialization - the slot stays uninitialized until assigned
+        environment.define(slot, Value(nullptr), node.isConstant(), false, pos);
     }
 }
 
-void Evaluator::executeVariableAssignment(const VariableAssignment& node) {
-    Value value = evaluateExpression(*node.value);
-    environment.assign(node.name, value, node.position);
+void Evaluator::executeVariableAssignment(const ASTNode& node, const Position& pos) {
+    Value value = evaluateExpression(node.value());
+    environment.assign((*program)[node.target()].slot(), value, pos);
 }
 
-void Evaluator::executePrintStatement(const PrintStatement& node) {
-    Value value = evaluateExpression(*node.expression);
-    std::cout << value.toString() << std::endl;
+void Evaluator::executePrintStatement(const ASTNode& node) {
+    output.writeLine(evaluateExpression(node.expression()));
 }
 
-Value Evaluator::evaluateExpression(const ASTNode& node) {
+Value Evaluator::evaluateExpression(NodeIndex index) {
+    const ASTNode& node = (*program)[index];
     switch (node.type) {
         case ASTNodeType::LITERAL:
-            return evaluateLiteral(static_cast<const Literal&>(node));
+            return evaluateLiteral(node);
         case ASTNodeType::IDENTIFIER:
-            return evaluateIdentifier(static_cast<const Identifier&>(node));
+            return evaluateIdentifier(node, program->position(index));
         case ASTNodeType::BINARY_EXPRESSION:
-            return evaluateBinaryExpression(static_cast<const BinaryExpression&>(node));
+            return evaluateBinaryExpression(node, program->position(index));
         default:
-            ErrorHandler::reportError("Unknown expression type", node.position);
+            ErrorHandler::reportError("Unknown expression type", program->position(index));
     }
     return Value(nullptr);
 }
 
-Value Evaluator::evaluateLiteral(const Literal& node) {
-    switch (node.token.type) {
-        case TokenType::STRING:
-            return Value(node.token.value);
-        case TokenType::INTEGER:
-            return Value(std::stoi(node.token.value));
-        case TokenType::FLOAT:
-            return Value(std::stod(node.token.value));
-        case TokenType::BOOLEAN:
-            return Value(node.token.value == "true");
-        case TokenType::NIL:
-            return Value(nullptr);
-        default:
-            ErrorHandler::reportError("Unknown literal type", node.position);
-    }
-    return Value(nullptr);
+Value Evaluator::evaluateLiteral(const ASTNode& node) {
+    return program->constants[node.constant()];
 }
 
-Value Evaluator::evaluateIdentifier(const Identifier& node) {
-    return environment.get(node.name, node.position);
+Value Evaluator::evaluateIdentifier(const ASTNode& node, const Position& pos) {
+    return environment.get(node.slot(), pos);
 }
 
-Value Evaluator::evaluateBinaryExpression(const BinaryExpression& node) {
-    Value left = evaluateExpression(*node.left);
-    Value right = evaluateExpression(*node.right);
+Value Evaluator::evaluateBinaryExpression(const ASTNode& node, const Position& pos) {
+    Value left = evaluateExpression(node.left());
+    Value right = evaluateExpression(node.right());
     
-    return ArithmeticEvaluator::evaluateBinaryExpression(node, left, right);
+    if (node.operand_types.known()) {
+        return ArithmeticEvaluator::evaluate(node.op, node.operand_types, left, right, pos);
+    }
+    return TypeFeedback::evaluate(sites[node.site()], node.op, left, right, pos);
 }
 
-} // namespace Lizard
\ No newline at end of file
+} // namespace Lizard
@@ -0,0 +1,198 @@
+#include "type_feedback.h"
+#include "eval_arithmetic.h"
+#include <algorithm>
+
+namespace Lizard {
+
+namespace {
+
+constexpr size_t REPORT_SITES = 10;
+
+const char* operatorSymbol(BinaryOperator op) {
+    switch (op) {
+        case BinaryOperator::ADD:      return "+";
+        case BinaryOperator::SUBTRACT: return "-";
+        case BinaryOperator::MULTIPLY: return "*";
+        case BinaryOperator::DIVIDE:   return "/";
+        case BinaryOperator::INT_DIV:  return "//";
+        case BinaryOperator::MODULO:   return "%";
+    }
+    return "?";
+}
+
+bool integerOp(BinaryOperator op, int64_t left, int64_t right, Value& result) {
+    int64_t value;
+    switch (op) {
+        case BinaryOperator::ADD:
+            if (__builtin_add_overflow(left, right, &value)) return false;
+            break;
+        case BinaryOperator::SUBTRACT:
+            if (__builtin_sub_overflow(left, right, &value)) return false;
+            break;
+        case BinaryOperator::MULTIPLY:
+            if (__builtin_mul_overflow(left, right, &value)) return false;
+            break;
+        case BinaryOperator::DIVIDE:
+            if (right == 0) return false;
+            result = Value(static_cast<double>(left) / static_cast<double>(right));
+            return true;
+        case BinaryOperator::INT_DIV:
+            if (right == 0) return false;
+            value = left / right;
+            break;
+        case BinaryOperator::MODULO:
+            if (right == 0) return false;
+            value = left % right;
+            break;
+        default:
+            return false;
+    }
+    result = Value(value);
+    return true;
+}
+
+bool floatOp(BinaryOperator op, double left, double right, Value& result) {
+    switch (op) {
+        case BinaryOperator::ADD:      result = Value(left + right); return true;
+        case BinaryOperator::SUBTRACT: result = Value(left - right); return true;
+        case BinaryOperator::MULTIPLY: result = Value(left * right); return true;
+        case BinaryOperator::DIVIDE:
+            if (right == 0.0) return false;
+            result = Value(left / right);
+            return true;
+        default:
+            // '//' and '%' truncate to integers; leave them to the generic path
+            return false;
+    }
+}
+
+} // namespace
+
+Value TypeFeedback::evaluate(BinarySite& site, BinaryOperator op, const Value& left,
+                             const Value& right, const Position& pos) {
+    Value result;
+    if (tryHandler(site.handler, op, left, right, result)) {
+        site.hits++;
+        return result;
+    }
+    
+    if (site.handler == BinaryHandler::UNINITIALIZED) {
+        site.op = op;
+        site.position = &pos;
+        site.handler = select(op, left, right);
+        if (tryHandler(site.handler, op, left, right, result)) {
+            site.hits++;
+            return result;
+        }
+    }
+    
+    // The operand types changed (or never suited a handler): stay generic
+    site.handler = BinaryHandler::GENERIC;
+    site.misses++;
+    return ArithmeticEvaluator::evaluate(op, left, right, pos);
+}
+
+BinaryHandler TypeFeedback::select(BinaryOperator op, const Value& left, const Value& right) {
+    if (left.isSmallInteger() && right.isSmallInteger()) {
+        return BinaryHandler::INT_INT;
+    }
+    if (left.isFloat() && right.isFloat()) {
+        return BinaryHandler::FLOAT_FLOAT;
+    }
+    if ((left.isFloat() && right.isSmallInteger()) || (left.isSmallInteger() && right.isFloat())) {
+        return BinaryHandler::INT_FLOAT;
+    }
+    if (op == BinaryOperator::ADD && (left.isString() || right.isString())) {
+        return BinaryHandler::STRING_ANY;
+    }
+    return BinaryHandler::GENERIC;
+}
+
+bool TypeFeedback::tryHandler(BinaryHandler handler, BinaryOperator op, const Value& left,
+                              const Value& right, Value& result) {
+    switch (handler) {
+        case BinaryHandler::INT_INT:
+            return left.isSmallInteger() && right.isSmallInteger() &&
+                   integerOp(op, left.get<int64_t>(), right.get<int64_t>(), result);
+        case BinaryHandler::FLOAT_FLOAT:
+            return left.isFloat() && right.isFloat() &&
+                   floatOp(op, left.get<double>(), right.get<double>(), result);
+        case BinaryHandler::INT_FLOAT:
+            if (left.isFloat() && right.isSmallInteger()) {
+                return floatOp(op, left.get<double>(), static_cast<double>(right.get<int64_t>()), result);
+            }
+            if (left.isSmallInteger() && right.isFloat()) {
+                return floatOp(op, static_cast<double>(left.get<int64_t>()), right.get<double>(), result);
+            }
+            return false;
+        case BinaryHandler::STRING_ANY: {
+            if (!left.isString() && !right.isString()) {
+                return false;
+            }
+            std::string text;
+            left.appendTo(text);
+            right.appendTo(text);
+            result = Value(std::move(text));
+            return true;
+        }
+        case BinaryHandler::UNINITIALIZED:
+        case BinaryHandler::GENERIC:
+            return false;
+    }
+    return false;
+}
+
+void TypeFeedback::printReport(std::ostream& out, const std::vector<BinarySite>& sites) {
+    constexpr size_t HANDLER_COUNT = static_cast<size_t>(BinaryHandler::STRING_ANY) + 1;
+    uint64_t sites_per_handler[HANDLER_COUNT] = {};
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    std::vector<const BinarySite*> missed;
+    
+    for (const BinarySite& site : sites) {
+        if (site.handler == BinaryHandler::UNINITIALIZED) {
+            continue;
+        }
+        sites_per_handler[static_cast<size_t>(site.handler)]++;
+        hits += site.hits;
+        misses += site.misses;
+        if (site.misses > 0) {
+            missed.push_back(&site);
+        }
+    }
+    
+    out << "Binary operation feedback: " << hits << " hits, " << misses << " misses\n";
+    for (size_t i = 1; i < HANDLER_COUNT; ++i) {
+        if (sites_per_handler[i] > 0) {
+            out << "  " << handlerName(static_cast<BinaryHandler>(i)) << ": "
+                << sites_per_handler[i] << " sites\n";
+        }
+    }
+    
+    std::sort(missed.begin(), missed.end(), [](const BinarySite* a, const BinarySite* b) {
+        return a->misses > b->misses;
+    });
+    if (missed.size() > REPORT_SITES) {
+        missed.resize(REPORT_SITES);
+    }
+    for (const BinarySite* site : missed) {
+        out << "  " << site->position->filename() << ":" << site->position->line << ":"
+            << site->position->column << " '" << operatorSymbol(site->op) << "' "
+            << handlerName(site->handler) << " hits=" << site->hits
+            << " misses=" << site->misses << "\n";
+    }
+}
+
+const char* TypeFeedback::handlerName(BinaryHandler handler) {
+    switch (handler) {
+        case BinaryHandler::UNINITIALIZED: return "uninitialized";
+        case BinaryHandler::GENERIC:       return "generic";
+        case BinaryHandler::INT_INT:       return "int,int";
+        case BinaryHandler::FLOAT_FLOAT:   return "float,float";
+        case BinaryHandler::INT_FLOAT:     return "int,float";
+        case BinaryHandler::STRING_ANY:    return "string,any";
+    }
+    return "unknown";
+}
+
+} // namespace Lizard
@@ -0,0 +1,126 @@
+#include "output_buffer.h"
+#include "number_format.h"
+#include <cerrno>
+#include <ctime>
+#include <unistd.h>
+
+namespace Lizard {
+
+OutputBuffer::OutputBuffer(int fd, size_t capacity)
+    : fd(fd), capacity(capacity), data(new char[capacity]),
+      last_flush(coarseNow()), last_check(last_flush) {}
+
+OutputBuffer::~OutputBuffer() {
+    flush();
+}
+
+void OutputBuffer::write(std::string_view text) {
+    if (text.size() > capacity - length) {
+        flush();
+        if (text.size() >= capacity) {
+            writeAll(text.data(), text.size());
+            return;
+        }
+    }
+    std::memcpy(data.get() + length, text.data(), text.size());
+    length += text.size();
+}
+
+void OutputBuffer::writeValue(const Value& value) {
+    switch (value.getType()) {
+        case ValueType::STRING:
+            write(value.asString());
+            return;
+        case ValueType::INTEGER: {
+            if (value.isBigInteger()) {
+                write(value.asBigInt().toString());
+                return;
+            }
+            if (capacity - length < NumberFormat::MAX_CHARS) {
+                flush();
+            }
+            char* begin = data.get() + length;
+            length += NumberFormat::formatInt(begin, value.get<int64_t>()) - begin;
+            return;
+        }
+        case ValueType::FLOAT: {
+            if (capacity - length < NumberFormat::MAX_CHARS) {
+                flush();
+            }
+            char* begin = data.get() + length;
+            length += NumberFormat::formatFloat(begin, value.get<double>()) - begin;
+            return;
+        }
+        case ValueType::BOOLEAN:
+            write(value.get<bool>() ? std::string_view("true") : std::string_view("false"));
+            return;
+        case ValueType::NIL:
+            write(std::string_view("nil"));
+            return;
+    }
+}
+
+void OutputBuffer::writeLine(const Value& value) {
+    writeValue(value);
+    write('\n');
+    
+    if (line_buffered) {
+        flush();
+    } else if (--lines_until_check == 0) {
+        checkClock();
+    }
+}
+
+void OutputBuffer::checkClock() {
+    std::chrono::steady_clock::time_point now = coarseNow();
+    if (now - last_flush >= FLUSH_INTERVAL) {
+        flush();
+        last_flush = now;
+    }
+    
+    // Lines that arrive within a millisecond of each other can go a while
+    // between looks; a slow line brings back a look per line
+    if (now - last_check < std::chrono::milliseconds(1)) {
+        clock_stride = clock_stride < MAX_CLOCK_STRIDE ? clock_stride * 2 : MAX_CLOCK_STRIDE;
+    } else {
+        clock_stride = 1;
+    }
+    lines_until_check = clock_stride;
+    last_check = now;
+}
+
+void OutputBuffer::flush() {
+    if (length > 0) {
+        writeAll(data.get(), length);
+        length = 0;
+    }
+}
+
+std::chrono::steady_clock::time_point OutputBuffer::coarseNow() {
+#ifdef CLOCK_MONOTONIC_COARSE
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+    return std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::seconds(now.tv_sec) + std::chrono::nanoseconds(now.tv_nsec)));
+#else
+    return std::chrono::steady_clock::now();
+#endif
+}
+
+void OutputBuffer::writeAll(const char* bytes, size_t count) {
+    // After a failed write (e.g. a closed pipe) further output is dropped
+    while (count > 0 && !failed) {
+        ssize_t written = ::write(fd, bytes, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            failed = true;
+            break;
+        }
+        bytes += written;
+        count -= static_cast<size_t>(written);
+    }
+}
+
+} // namespace Lizard
@@ -0,0 +1,41 @@
+#include "source_stream.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace Lizard {
+
+std::unique_ptr<SourceStream> SourceStream::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+    return std::unique_ptr<SourceStream>(new SourceStream(fd));
+}
+
+SourceStream::~SourceStream() {
+    close(fd);
+}
+
+bool SourceStream::fill() {
+    if (at_end) {
+        return false;
+    }
+
+    size_t old_size = buffer.size();
+    buffer.resize(old_size + CHUNK_SIZE);
+    ssize_t count;
+    do {
+        count = read(fd, &buffer[old_size], CHUNK_SIZE);
+    } while (count < 0 && errno == EINTR);
+
+    if (count <= 0) {
+        buffer.resize(old_size);
+        at_end = true;
+        return false;
+    }
+    buffer.resize(old_size + static_cast<size_t>(count));
+    return true;
+}
+
+} // namespace Lizard
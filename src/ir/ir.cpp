@@ -0,0 +1,120 @@
+#include "ir.h"
+
+namespace Lizard {
+
+namespace {
+
+const char* binaryName(BinaryOperator op) {
+    switch (op) {
+        case BinaryOperator::ADD:      return "add";
+        case BinaryOperator::SUBTRACT: return "sub";
+        case BinaryOperator::MULTIPLY: return "mul";
+        case BinaryOperator::DIVIDE:   return "div";
+        case BinaryOperator::INT_DIV:  return "idiv";
+        case BinaryOperator::MODULO:   return "mod";
+    }
+    return "?";
+}
+
+} // namespace
+
+size_t IRFunction::instructionCount() const {
+    size_t count = 0;
+    for (const IRBlock& block : blocks) {
+        count += block.instructions.size();
+    }
+    return count;
+}
+
+void IRFunction::print(std::ostream& out) const {
+    for (const IRBlock& block : blocks) {
+        out << block.name << ":\n";
+        for (IRValue value : block.instructions) {
+            const IRInstruction& ins = values[value];
+            out << "  ";
+            if (ins.producesValue()) {
+                out << "%" << value << " = ";
+            }
+            
+            switch (ins.op) {
+                case IROp::CONST: {
+                    const Value& constant = (*constants)[ins.operand];
+                    out << "const ";
+                    if (constant.isString()) {
+                        out << "\"" << constant.asString() << "\"";
+                    } else {
+                        out << constant.toString();
+                    }
+                    break;
+                }
+                case IROp::LOAD:
+                    out << "load " << (*slot_names)[ins.operand];
+                    break;
+                case IROp::DEFINE:
+                    out << (ins.fixed ? "define fix " : "define var ") << (*slot_names)[ins.operand]
+                        << ", %" << ins.a;
+                    break;
+                case IROp::DECLARE:
+                    out << (ins.fixed ? "declare fix " : "declare var ") << (*slot_names)[ins.operand];
+                    break;
+                case IROp::STORE:
+                    out << "store " << (*slot_names)[ins.operand] << ", %" << ins.a;
+                    break;
+                case IROp::BINARY:
+                    out << binaryName(ins.binary_op) << " %" << ins.a << ", %" << ins.b;
+                    break;
+                case IROp::PRINT:
+                    out << "print %" << ins.a;
+                    break;
+            }
+            out << "    ; " << ins.position.line << ":" << ins.position.column << "\n";
+        }
+    }
+}
+
+std::vector<IRType> inferTypes(const IRFunction& function) {
+    std::vector<IRType> types(function.values.size(), UNKNOWN_TYPE);
+    const IRType integer_type = irType(ValueType::INTEGER);
+    const IRType float_type = irType(ValueType::FLOAT);
+    const IRType string_type = irType(ValueType::STRING);
+    
+    for (const IRBlock& block : function.blocks) {
+        for (IRValue value : block.instructions) {
+            const IRInstruction& ins = function.values[value];
+            if (ins.op == IROp::CONST) {
+                types[value] = irType((*function.constants)[ins.operand].getType());
+                continue;
+            }
+            if (ins.op != IROp::BINARY) {
+                continue;
+            }
+            
+            IRType left = ins.types.known() ? irType(ins.types.left()) : types[ins.a];
+            IRType right = ins.types.known() ? irType(ins.types.right()) : types[ins.b];
+            if (ins.binary_op == BinaryOperator::ADD &&
+                (left == string_type || right == string_type)) {
+                types[value] = string_type;
+                continue;
+            }
+            bool numeric = (left == integer_type || left == float_type) &&
+                           (right == integer_type || right == float_type);
+            if (!numeric) {
+                continue;
+            }
+            switch (ins.binary_op) {
+                case BinaryOperator::DIVIDE:
+                    types[value] = float_type;
+                    break;
+                case BinaryOperator::INT_DIV:
+                case BinaryOperator::MODULO:
+                    types[value] = integer_type;
+                    break;
+                default:
+                    types[value] = left == integer_type && right == integer_type ? integer_type : float_type;
+            }
+        }
+    }
+    return types;
+}
+
+} // namespace Lizard
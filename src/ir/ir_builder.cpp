@@ -0,0 +1,85 @@
+#include "ir.h"
+#include "error_handler.h"
+
+namespace Lizard {
+
+IRFunction IRBuilder::build(Program& program) {
+    this->program = &program;
+    function = IRFunction();
+    function.constants = &program.constants;
+    function.slot_names = &program.slot_names;
+    function.blocks.push_back(IRBlock{"entry", {}});
+    function.values.reserve(program.nodes.size());
+
+    for (NodeIndex stmt : program.statements) {
+        lowerStatement(stmt);
+    }
+
+    return std::move(function);
+}
+
+void IRBuilder::lowerStatement(NodeIndex index) {
+    const ASTNode& node = (*program)[index];
+    const Position& pos = program->position(index);
+    switch (node.type) {
+        case ASTNodeType::VARIABLE_DECLARATION: {
+            IRInstruction ins(node.value() != NO_NODE ? IROp::DEFINE : IROp::DECLARE);
+            if (node.value() != NO_NODE) {
+                ins.a = lowerExpression(node.value());
+            }
+            ins.operand = (*program)[node.target()].slot();
+            ins.fixed = node.isConstant();
+            emit(ins, pos);
+            break;
+        }
+        case ASTNodeType::VARIABLE_ASSIGNMENT: {
+            IRInstruction ins(IROp::STORE);
+            ins.a = lowerExpression(node.value());
+            ins.operand = (*program)[node.target()].slot();
+            emit(ins, pos);
+            break;
+        }
+        case ASTNodeType::PRINT_STATEMENT: {
+            IRInstruction ins(IROp::PRINT);
+            ins.a = lowerExpression(node.expression());
+            emit(ins, pos);
+            break;
+        }
+        default:
+            ErrorHandler::reportError("Unknown statement type", pos);
+    }
+}
+
+IRValue IRBuilder::lowerExpression(NodeIndex index) {
+    const ASTNode& node = (*program)[index];
+    const Position& pos = program->position(index);
+    switch (node.type) {
+        case ASTNodeType::LITERAL: {
+            IRInstruction ins(IROp::CONST);
+            ins.operand = node.constant();
+            return emit(ins, pos);
+        }
+        case ASTNodeType::IDENTIFIER: {
+            IRInstruction ins(IROp::LOAD);
+            ins.operand = node.slot();
+            return emit(ins, pos);
+        }
+        case ASTNodeType::BINARY_EXPRESSION: {
+            IRInstruction ins(IROp::BINARY);
+            ins.a = lowerExpression(node.left());
+            ins.b = lowerExpression(node.right());
+            ins.binary_op = node.op;
+            ins.types = node.operand_types;
+            return emit(ins, pos);
+        }
+        default:
+            ErrorHandler::reportError("Unknown expression type", pos);
+    }
+}
+
+IRValue IRBuilder::emit(IRInstruction instruction, const Position& pos) {
+    instruction.position = pos;
+    return function.append(function.blocks.back(), instruction);
+}
+
+} // namespace Lizard
@@ -0,0 +1,117 @@
+#include "ir_codegen.h"
+
+namespace Lizard {
+
+namespace {
+
+OpCode binaryOpCode(BinaryOperator op) {
+    switch (op) {
+        case BinaryOperator::ADD:      return OpCode::ADD;
+        case BinaryOperator::SUBTRACT: return OpCode::SUBTRACT;
+        case BinaryOperator::MULTIPLY: return OpCode::MULTIPLY;
+        case BinaryOperator::DIVIDE:   return OpCode::DIVIDE;
+        case BinaryOperator::INT_DIV:  return OpCode::INT_DIV;
+        case BinaryOperator::MODULO:   return OpCode::MODULO;
+    }
+    return OpCode::ADD;
+}
+
+constexpr uint32_t NEVER_USED = UINT32_MAX;
+
+} // namespace
+
+bool IRCodegen::generate(const IRFunction& function, Chunk& chunk) {
+    chunk = Chunk();
+    chunk.constants = function.constants->all();
+    chunk.names = *function.slot_names;
+    chunk.code.reserve(function.instructionCount());
+    chunk.positions.reserve(function.instructionCount());
+
+    // Index of the last instruction that reads each value
+    std::vector<uint32_t> last_use(function.values.size(), NEVER_USED);
+    uint32_t index = 0;
+    for (const IRBlock& block : function.blocks) {
+        for (IRValue value : block.instructions) {
+            const IRInstruction& ins = function.values[value];
+            if (ins.a != NO_VALUE) last_use[ins.a] = index;
+            if (ins.b != NO_VALUE) last_use[ins.b] = index;
+            index++;
+        }
+    }
+
+    std::vector<IRType> types = inferTypes(function);
+    std::vector<uint16_t> registers(function.values.size(), 0);
+    std::vector<uint16_t> free_registers;
+    uint32_t register_count = 0;
+
+    index = 0;
+    for (const IRBlock& block : function.blocks) {
+        for (IRValue value : block.instructions) {
+            const IRInstruction& ins = function.values[value];
+            uint16_t a = ins.a != NO_VALUE ? registers[ins.a] : 0;
+            uint16_t b = ins.b != NO_VALUE ? registers[ins.b] : 0;
+
+            // Operands are read before the result is written, so a dying
+            // operand's register can hold the result
+            if (ins.a != NO_VALUE && last_use[ins.a] == index) {
+                free_registers.push_back(a);
+            }
+            if (ins.b != NO_VALUE && ins.b != ins.a && last_use[ins.b] == index) {
+                free_registers.push_back(b);
+            }
+
+            uint16_t dst = 0;
+            if (ins.producesValue()) {
+                if (!free_registers.empty()) {
+                    dst = free_registers.back();
+                    free_registers.pop_back();
+                } else if (register_count == UINT16_MAX) {
+                    return false;
+                } else {
+                    dst = static_cast<uint16_t>(register_count++);
+                }
+                registers[value] = dst;
+            }
+
+            switch (ins.op) {
+                case IROp::CONST:
+                    chunk.emit(Instruction(OpCode::LOAD_CONST, dst, ins.operand), ins.position);
+                    break;
+                case IROp::LOAD:
+                    chunk.emit(Instruction(OpCode::GET_VAR, dst, ins.operand), ins.position);
+                    break;
+                case IROp::DEFINE:
+                    chunk.emit(Instruction(OpCode::DEFINE_VAR, a, ins.operand, ins.fixed ? 1 : 0), ins.position);
+                    break;
+                case IROp::DECLARE:
+                    chunk.emit(Instruction(OpCode::DECLARE_VAR, 0, ins.operand, ins.fixed ? 1 : 0), ins.position);
+                    break;
+                case IROp::STORE:
+                    chunk.emit(Instruction(OpCode::SET_VAR, a, ins.operand), ins.position);
+                    break;
+                case IROp::BINARY: {
+                    Instruction instruction(binaryOpCode(ins.binary_op), dst, a, b);
+                    instruction.types = ins.types;
+                    if (!ins.types.known() && types[ins.a] != UNKNOWN_TYPE && types[ins.b] != UNKNOWN_TYPE) {
+                        instruction.types = TypePair(valueType(types[ins.a]), valueType(types[ins.b]));
+                    }
+                    chunk.emit(instruction, ins.position);
+                    break;
+                }
+                case IROp::PRINT:
+                    chunk.emit(Instruction(OpCode::PRINT, a), ins.position);
+                    break;
+            }
+
+            if (ins.producesValue() && last_use[value] == NEVER_USED) {
+                free_registers.push_back(dst);
+            }
+            index++;
+        }
+    }
+
+    chunk.register_count = register_count;
+    return true;
+}
+
+} // namespace Lizard
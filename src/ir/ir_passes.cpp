@@ -0,0 +1,425 @@
+#include "ir_passes.h"
+#include "eval_arithmetic.h"
+
+namespace Lizard {
+
+namespace {
+
+std::vector<IRValue> identityMap(const IRFunction& function) {
+    std::vector<IRValue> forward(function.values.size());
+    for (IRValue i = 0; i < forward.size(); ++i) {
+        forward[i] = i;
+    }
+    return forward;
+}
+
+// Operands are always defined earlier, so their final replacement is known
+// by the time an instruction is visited
+void remapOperands(IRInstruction& ins, const std::vector<IRValue>& forward) {
+    if (ins.a != NO_VALUE) ins.a = forward[ins.a];
+    if (ins.b != NO_VALUE) ins.b = forward[ins.b];
+}
+
+// Open-addressing map from (operator, left, right) to the value that first
+// computed it. Blocks hold hundreds of thousands of binary operations, so
+// this stays a flat array rather than a node-based map.
+class ExpressionTable {
+public:
+    // Returns the value already recorded for the expression, or records
+    // `value` and returns NO_VALUE
+    IRValue findOrInsert(BinaryOperator op, IRValue left, IRValue right, IRValue value) {
+        if ((count + 1) * 2 > entries.size()) {
+            grow();
+        }
+        uint64_t operands = (static_cast<uint64_t>(left) << 32) | right;
+        size_t mask = entries.size() - 1;
+        for (size_t i = hash(op, operands) & mask;; i = (i + 1) & mask) {
+            Entry& entry = entries[i];
+            if (entry.value == NO_VALUE) {
+                entry = Entry{operands, op, value};
+                count++;
+                return NO_VALUE;
+            }
+            if (entry.operands == operands && entry.op == op) {
+                return entry.value;
+            }
+        }
+    }
+    
+    // Sizes the table for `expected` expressions and forgets every entry
+    void reset(size_t expected) {
+        size_t capacity = 1024;
+        while (capacity < expected * 2) {
+            capacity *= 2;
+        }
+        entries.assign(capacity, Entry{});
+        count = 0;
+    }
+    
+private:
+    struct Entry {
+        uint64_t operands;
+        BinaryOperator op;
+        IRValue value = NO_VALUE;
+    };
+    
+    std::vector<Entry> entries;
+    size_t count = 0;
+    
+    static size_t hash(BinaryOperator op, uint64_t operands) {
+        uint64_t left = operands >> 32;
+        uint64_t right = operands & 0xFFFFFFFF;
+        return static_cast<size_t>(((left * 3 + right) << 3) + static_cast<uint64_t>(op));
+    }
+    
+    void grow() {
+        std::vector<Entry> old = std::move(entries);
+        entries.assign(old.empty() ? 1024 : old.size() * 2, Entry{});
+        count = 0;
+        for (const Entry& entry : old) {
+            if (entry.value != NO_VALUE) {
+                findOrInsert(entry.op, static_cast<IRValue>(entry.operands >> 32),
+                             static_cast<IRValue>(entry.operands), entry.value);
+            }
+        }
+    }
+};
+
+bool isNumeric(IRType type) {
+    return type == irType(ValueType::INTEGER) || type == irType(ValueType::FLOAT);
+}
+
+// True when a binary operation with these operands always produces a value
+bool cannotFail(const IRFunction& function, const IRInstruction& ins, const std::vector<IRType>& types) {
+    IRType left = ins.types.known() ? irType(ins.types.left()) : types[ins.a];
+    IRType right = ins.types.known() ? irType(ins.types.right()) : types[ins.b];
+
+    if (ins.binary_op == BinaryOperator::ADD &&
+        (left == irType(ValueType::STRING) || right == irType(ValueType::STRING))) {
+        return true;
+    }
+    if (!isNumeric(left) || !isNumeric(right)) {
+        return false;
+    }
+
+    switch (ins.binary_op) {
+        case BinaryOperator::DIVIDE:
+        case BinaryOperator::INT_DIV:
+        case BinaryOperator::MODULO: {
+            // An integer dividend is always finite, so only the divisor matters
+            const IRInstruction& divisor = function.values[ins.b];
+            return left == irType(ValueType::INTEGER) && divisor.op == IROp::CONST &&
+                   ArithmeticEvaluator::canEvaluate(ins.binary_op, Value(0),
+                                                    (*function.constants)[divisor.operand]);
+        }
+        default:
+            return true;
+    }
+}
+
+} // namespace
+
+bool CopyPropagation::run(IRFunction& function) {
+    std::vector<IRValue> forward = identityMap(function);
+    std::vector<IRValue> current(function.slot_names->size());
+    bool changed = false;
+
+    for (IRBlock& block : function.blocks) {
+        std::fill(current.begin(), current.end(), NO_VALUE);
+        std::vector<IRValue> kept;
+        kept.reserve(block.instructions.size());
+
+        for (IRValue value : block.instructions) {
+            IRInstruction& ins = function.values[value];
+            remapOperands(ins, forward);
+            switch (ins.op) {
+                case IROp::LOAD:
+                    // A slot written earlier in the block holds exactly that value
+                    if (current[ins.operand] != NO_VALUE) {
+                        forward[value] = current[ins.operand];
+                        changed = true;
+                        continue;
+                    }
+                    break;
+                case IROp::DEFINE:
+                case IROp::STORE:
+                    current[ins.operand] = ins.a;
+                    break;
+                case IROp::DECLARE:
+                    current[ins.operand] = NO_VALUE;
+                    break;
+                default:
+                    break;
+            }
+            kept.push_back(value);
+        }
+        block.instructions = std::move(kept);
+    }
+    return changed;
+}
+
+bool CommonSubexpressionElimination::run(IRFunction& function) {
+    std::vector<IRValue> forward = identityMap(function);
+    std::vector<IRValue> loaded(function.slot_names->size());
+    ExpressionTable computed;
+    bool changed = false;
+
+    for (IRBlock& block : function.blocks) {
+        std::fill(loaded.begin(), loaded.end(), NO_VALUE);
+        computed.reset(block.instructions.size() / 2);
+        std::vector<IRValue> kept;
+        kept.reserve(block.instructions.size());
+
+        for (IRValue value : block.instructions) {
+            IRInstruction& ins = function.values[value];
+            remapOperands(ins, forward);
+            if (ins.op == IROp::LOAD) {
+                // The earlier load succeeded, so the slot is initialized and unchanged
+                IRValue& previous = loaded[ins.operand];
+                if (previous != NO_VALUE) {
+                    forward[value] = previous;
+                    changed = true;
+                    continue;
+                }
+                previous = value;
+            } else if (ins.writesSlot()) {
+                loaded[ins.operand] = NO_VALUE;
+            } else if (ins.op == IROp::BINARY) {
+                // Same operator on the same values: same result, and no error
+                // since the first one completed
+                IRValue previous = computed.findOrInsert(ins.binary_op, ins.a, ins.b, value);
+                if (previous != NO_VALUE) {
+                    forward[value] = previous;
+                    changed = true;
+                    continue;
+                }
+            }
+            kept.push_back(value);
+        }
+        block.instructions = std::move(kept);
+    }
+    return changed;
+}
+
+bool GlobalValueNumbering::run(IRFunction& function) {
+    std::vector<IRValue> forward = identityMap(function);
+    std::vector<IRType> types = inferTypes(function);
+    std::vector<IRValue> constants; // by pool index
+    ExpressionTable computed;
+    bool changed = false;
+
+    for (IRBlock& block : function.blocks) {
+        constants.assign(function.constants->size(), NO_VALUE);
+        computed.reset(block.instructions.size() / 2);
+        std::vector<IRValue> kept;
+        kept.reserve(block.instructions.size());
+
+        for (IRValue value : block.instructions) {
+            IRInstruction& ins = function.values[value];
+            remapOperands(ins, forward);
+
+            if (ins.op == IROp::BINARY && function.values[ins.a].op == IROp::CONST &&
+                function.values[ins.b].op == IROp::CONST) {
+                const Value& left = (*function.constants)[function.values[ins.a].operand];
+                const Value& right = (*function.constants)[function.values[ins.b].operand];
+                if (ArithmeticEvaluator::canEvaluate(ins.binary_op, left, right)) {
+                    Value result = ArithmeticEvaluator::evaluate(ins.binary_op, left, right, ins.position);
+                    ins.op = IROp::CONST;
+                    ins.operand = function.constants->add(result);
+                    ins.a = ins.b = NO_VALUE;
+                    types[value] = irType(result.getType());
+                    changed = true;
+                }
+            }
+
+            if (ins.op == IROp::CONST) {
+                if (ins.operand >= constants.size()) {
+                    constants.resize(function.constants->size(), NO_VALUE);
+                }
+                IRValue& leader = constants[ins.operand];
+                if (leader == NO_VALUE) {
+                    leader = value;
+                } else {
+                    forward[value] = leader;
+                    changed = true;
+                    continue;
+                }
+            } else if (ins.op == IROp::BINARY) {
+                IRValue left = ins.a;
+                IRValue right = ins.b;
+                bool commutative = ins.binary_op == BinaryOperator::ADD ||
+                                   ins.binary_op == BinaryOperator::MULTIPLY;
+                // String concatenation is not commutative
+                if (commutative && isNumeric(types[left]) && isNumeric(types[right]) && right < left) {
+                    std::swap(left, right);
+                }
+                IRValue previous = computed.findOrInsert(ins.binary_op, left, right, value);
+                if (previous != NO_VALUE) {
+                    forward[value] = previous;
+                    changed = true;
+                    continue;
+                }
+            }
+            kept.push_back(value);
+        }
+        block.instructions = std::move(kept);
+    }
+    return changed;
+}
+
+bool DeadStoreElimination::run(IRFunction& function) {
+    size_t slot_count = function.slot_names->size();
+    std::vector<IRValue> unread(slot_count);   // last write not yet loaded
+    std::vector<bool> mutable_slot(slot_count); // defined by `var`, so stores cannot fail
+    std::vector<bool> dead(function.values.size(), false);
+    bool changed = false;
+
+    for (IRBlock& block : function.blocks) {
+        std::fill(unread.begin(), unread.end(), NO_VALUE);
+        std::fill(mutable_slot.begin(), mutable_slot.end(), false);
+
+        for (IRValue value : block.instructions) {
+            IRInstruction& ins = function.values[value];
+            switch (ins.op) {
+                case IROp::LOAD:
+                    unread[ins.operand] = NO_VALUE;
+                    break;
+                case IROp::DEFINE:
+                    mutable_slot[ins.operand] = !ins.fixed;
+                    unread[ins.operand] = ins.fixed ? NO_VALUE : value;
+                    break;
+                case IROp::DECLARE:
+                    mutable_slot[ins.operand] = !ins.fixed;
+                    unread[ins.operand] = NO_VALUE;
+                    break;
+                case IROp::STORE: {
+                    if (!mutable_slot[ins.operand]) {
+                        unread[ins.operand] = NO_VALUE;
+                        break;
+                    }
+                    IRValue previous = unread[ins.operand];
+                    if (previous != NO_VALUE) {
+                        IRInstruction& overwritten = function.values[previous];
+                        if (overwritten.op == IROp::DEFINE) {
+                            overwritten.op = IROp::DECLARE;
+                            overwritten.a = NO_VALUE;
+                        } else {
+                            dead[previous] = true;
+                        }
+                        changed = true;
+                    }
+                    unread[ins.operand] = value;
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+
+        if (changed) {
+            std::vector<IRValue> kept;
+            kept.reserve(block.instructions.size());
+            for (IRValue value : block.instructions) {
+                if (!dead[value]) {
+                    kept.push_back(value);
+                }
+            }
+            block.instructions = std::move(kept);
+        }
+    }
+    return changed;
+}
+
+bool DeadCodeElimination::run(IRFunction& function) {
+    std::vector<IRType> types = inferTypes(function);
+    std::vector<uint32_t> uses(function.values.size(), 0);
+    std::vector<bool> safe_load(function.values.size(), false);
+    std::vector<bool> initialized(function.slot_names->size());
+    bool changed = false;
+
+    for (IRBlock& block : function.blocks) {
+        std::fill(initialized.begin(), initialized.end(), false);
+        for (IRValue value : block.instructions) {
+            const IRInstruction& ins = function.values[value];
+            if (ins.a != NO_VALUE) uses[ins.a]++;
+            if (ins.b != NO_VALUE) uses[ins.b]++;
+            switch (ins.op) {
+                case IROp::LOAD:
+                    safe_load[value] = initialized[ins.operand];
+                    initialized[ins.operand] = true;
+                    break;
+                case IROp::DEFINE:
+                case IROp::STORE:
+                    initialized[ins.operand] = true;
+                    break;
+                case IROp::DECLARE:
+                    initialized[ins.operand] = false;
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    // Walking backwards frees the operands of a removed value before they
+    // are visited themselves
+    for (IRBlock& block : function.blocks) {
+        std::vector<IRValue> kept;
+        kept.reserve(block.instructions.size());
+        for (auto it = block.instructions.rbegin(); it != block.instructions.rend(); ++it) {
+            IRValue value = *it;
+            const IRInstruction& ins = function.values[value];
+            bool removable = false;
+            if (ins.producesValue() && uses[value] == 0) {
+                switch (ins.op) {
+                    case IROp::CONST:  removable = true; break;
+                    case IROp::LOAD:   removable = safe_load[value]; break;
+                    case IROp::BINARY: removable = cannotFail(function, ins, types); break;
+                    default: break;
+                }
+            }
+            if (removable) {
+                if (ins.a != NO_VALUE) uses[ins.a]--;
+                if (ins.b != NO_VALUE) uses[ins.b]--;
+                changed = true;
+            } else {
+                kept.push_back(value);
+            }
+        }
+        block.instructions.assign(kept.rbegin(), kept.rend());
+    }
+    return changed;
+}
+
+PassManager PassManager::forLevel(int level) {
+    PassManager manager;
+    if (level >= 1) {
+        manager.add(std::make_unique<CopyPropagation>());
+        manager.add(std::make_unique<CommonSubexpressionElimination>());
+    }
+    if (level >= 2) {
+        manager.add(std::make_unique<GlobalValueNumbering>());
+        manager.add(std::make_unique<DeadStoreElimination>());
+    }
+    if (level >= 1) {
+        manager.add(std::make_unique<DeadCodeElimination>());
+    }
+    return manager;
+}
+
+void PassManager::run(IRFunction& function, std::ostream* dump) {
+    if (dump) {
+        *dump << "; lowered (" << function.instructionCount() << " instructions)\n";
+        function.print(*dump);
+    }
+    for (const auto& pass : passes) {
+        bool changed = pass->run(function);
+        if (dump) {
+            *dump << "; after " << pass->name() << " (" << function.instructionCount() << " instructions"
+                  << (changed ? "" : ", unchanged") << ")\n";
+            function.print(*dump);
+        }
+    }
+}
+
+} // namespace Lizard
@@ -0,0 +1,584 @@
+#include "jit.h"
+
+#if defined(__x86_64__) && defined(__linux__)
+#include "x86_assembler.h"
+#include <cstddef>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace Lizard {
+
+#if defined(__x86_64__) && defined(__linux__)
+
+namespace {
+
+// Native code compiled per batch before the mapping is reused
+constexpr size_t BATCH_BYTES = size_t(1) << 20;
+
+// Called from generated code before a heap value in a register or variable
+// is overwritten; releases it without throwing
+void releaseSlot(Value* slot) {
+    *slot = Value(nullptr);
+}
+
+} // namespace
+
+// Emits native code for regions. Register conventions inside a region:
+//   rbx  VM register file      r13  Value::BOX_BASE (floats are below it)
+//   r12  Variable array        r14  Value::INTEGER_TAG
+//                              r15  Value::STRING_TAG (heap values are at or above it)
+// rax, rcx, rdx, rsi, rdi and xmm0-2 are scratch.
+class JitCompiler {
+public:
+    explicit JitCompiler(const Chunk& chunk)
+        : chunk(chunk), kinds(chunk.register_count, UNKNOWN), variable_kinds(chunk.names.size(), UNKNOWN),
+          writable(chunk.names.size(), false) {}
+
+    static bool isEligible(const Chunk& chunk, size_t pc);
+
+    // Starts a new batch; offsets returned by compileRegion are relative to it
+    void reset() { assembler.clear(); }
+    size_t size() const { return assembler.size(); }
+    // Appends the region [start, end) and returns its offset. Variable
+    // types are speculated from `variables`.
+    size_t compileRegion(size_t start, size_t end, const Variable* variables);
+    // Resolves the batch's jumps and returns its code
+    const std::vector<uint8_t>& finish();
+
+private:
+    using Label = X86Assembler::Label;
+
+    // What a VM register is known to hold at this point of the region
+    enum Kind : uint8_t {
+        UNKNOWN,    // anything, including a heap value to release
+        IMMEDIATE,  // not a heap value
+        SMALL_INT,
+        FLOAT
+    };
+
+    // Out-of-line code, emitted after the region body
+    struct ColdPath {
+        Label label;
+        Label resume;   // RELEASE only
+        uint32_t pc;    // BAILOUT only
+        Mem slot;       // RELEASE only
+        bool release;
+    };
+
+    const Chunk& chunk;
+    X86Assembler assembler;
+    std::vector<Kind> kinds;
+    std::vector<uint16_t> touched;
+    // Per variable slot: the kind of its value and whether SET_VAR's
+    // checks already passed, once the region has guarded them
+    std::vector<Kind> variable_kinds;
+    std::vector<bool> writable;
+    std::vector<uint32_t> touched_variables;
+    const Variable* variables = nullptr;
+    std::vector<ColdPath> cold_paths;
+    Label exit_label = 0;
+    Label release_routine = 0;
+
+    static Mem registerSlot(uint32_t reg) { return Mem{Reg::RBX, static_cast<int32_t>(reg * 8)}; }
+    static Mem variableField(uint32_t slot, size_t field) {
+        return Mem{Reg::R12, static_cast<int32_t>(slot * sizeof(Variable) + field)};
+    }
+    static bool isNumeric(Kind kind) { return kind == SMALL_INT || kind == FLOAT; }
+
+    Label bailout(size_t pc);
+    void releaseHeapValue(Mem slot);
+    void storeResult(uint16_t reg, Kind kind);
+    void branchIfNotSmallInteger(Reg value, Label target);
+    void unboxInteger(Reg reg);
+    void boxInteger(Reg reg, Label overflow);
+    void toDouble(Reg value, Kind kind, Xmm dst, Label fail);
+    void emitColdPaths();
+
+    void compileLoadConst(const Instruction& ins);
+    void compileGetVar(const Instruction& ins, size_t pc);
+    void compileSetVar(const Instruction& ins, size_t pc);
+    void compileArithmetic(const Instruction& ins, size_t pc);
+};
+
+bool JitCompiler::isEligible(const Chunk& chunk, size_t pc) {
+    const Instruction& ins = chunk.code[pc];
+    switch (ins.op) {
+        case OpCode::LOAD_CONST:
+            return !chunk.constants[ins.b].isHeap();
+        case OpCode::GET_VAR:
+        case OpCode::SET_VAR:
+            return (static_cast<uint64_t>(ins.b) + 1) * sizeof(Variable) < INT32_MAX;
+        case OpCode::ADD:
+        case OpCode::SUBTRACT:
+        case OpCode::MULTIPLY:
+        case OpCode::DIVIDE:
+        case OpCode::INT_DIV:
+        case OpCode::MODULO: {
+            if (!ins.types.known()) {
+                return true;
+            }
+            // Statically known to take a path the native code cannot
+            ValueType left = ins.types.left();
+            ValueType right = ins.types.right();
+            if (ins.op == OpCode::INT_DIV || ins.op == OpCode::MODULO) {
+                return left == ValueType::INTEGER && right == ValueType::INTEGER;
+            }
+            return (left == ValueType::INTEGER || left == ValueType::FLOAT) &&
+                   (right == ValueType::INTEGER || right == ValueType::FLOAT);
+        }
+        default:
+            return false;
+    }
+}
+
+size_t JitCompiler::compileRegion(size_t start, size_t end, const Variable* current) {
+    X86Assembler& a = assembler;
+    size_t offset = a.size();
+    cold_paths.clear();
+    for (uint16_t reg : touched) {
+        kinds[reg] = UNKNOWN;
+    }
+    touched.clear();
+    for (uint32_t slot : touched_variables) {
+        variable_kinds[slot] = UNKNOWN;
+        writable[slot] = false;
+    }
+    touched_variables.clear();
+    variables = current;
+    exit_label = a.newLabel();
+    release_routine = a.newLabel();
+
+    a.push(Reg::RBX);
+    a.push(Reg::R12);
+    a.push(Reg::R13);
+    a.push(Reg::R14);
+    a.push(Reg::R15);
+    a.mov(Reg::RBX, Reg::RDI);
+    a.mov(Reg::R12, Reg::RSI);
+    a.mov(Reg::R13, Value::BOX_BASE);
+    a.mov(Reg::R14, Value::INTEGER_TAG);
+    a.mov(Reg::R15, Value::STRING_TAG);
+
+    for (size_t pc = start; pc < end; ++pc) {
+        const Instruction& ins = chunk.code[pc];
+        switch (ins.op) {
+            case OpCode::LOAD_CONST: compileLoadConst(ins); break;
+            case OpCode::GET_VAR:    compileGetVar(ins, pc); break;
+            case OpCode::SET_VAR:    compileSetVar(ins, pc); break;
+            default:                 compileArithmetic(ins, pc); break;
+        }
+    }
+    a.mov32(Reg::RAX, static_cast<uint32_t>(end));
+
+    a.bind(exit_label);
+    a.pop(Reg::R15);
+    a.pop(Reg::R14);
+    a.pop(Reg::R13);
+    a.pop(Reg::R12);
+    a.pop(Reg::RBX);
+    a.ret();
+
+    emitColdPaths();
+    return offset;
+}
+
+const std::vector<uint8_t>& JitCompiler::finish() {
+    assembler.finish();
+    return assembler.code();
+}
+
+JitCompiler::Label JitCompiler::bailout(size_t pc) {
+    Label label = assembler.newLabel();
+    cold_paths.push_back(ColdPath{label, 0, static_cast<uint32_t>(pc), Mem{Reg::RAX, 0}, false});
+    return label;
+}
+
+// Releases the value in `slot` if it is a heap object; rax is preserved
+void JitCompiler::releaseHeapValue(Mem slot) {
+    X86Assembler& a = assembler;
+    Label release = a.newLabel();
+    Label resume = a.newLabel();
+    a.mov(Reg::RCX, slot);
+    a.cmp(Reg::RCX, Reg::R15);
+    a.j(Condition::AE, release);
+    a.bind(resume);
+    cold_paths.push_back(ColdPath{release, resume, 0, slot, true});
+}
+
+void JitCompiler::storeResult(uint16_t reg, Kind kind) {
+    if (kinds[reg] == UNKNOWN) {
+        releaseHeapValue(registerSlot(reg));
+        touched.push_back(reg);
+    }
+    assembler.mov(registerSlot(reg), Reg::RAX);
+    kinds[reg] = kind;
+}
+
+// Uses rsi as scratch so rcx stays free for callers
+void JitCompiler::branchIfNotSmallInteger(Reg value, Label target) {
+    assembler.mov(Reg::RSI, value);
+    assembler.sub(Reg::RSI, Reg::R14);
+    assembler.shr(Reg::RSI, 48);
+    assembler.j(Condition::NE, target);
+}
+
+// Sign-extends the 48-bit payload
+void JitCompiler::unboxInteger(Reg reg) {
+    assembler.shl(reg, 16);
+    assembler.sar(reg, 16);
+}
+
+// Results outside the immediate range need a BigInt, which only the
+// interpreter can allocate
+void JitCompiler::boxInteger(Reg reg, Label overflow) {
+    X86Assembler& a = assembler;
+    a.mov(Reg::RCX, reg);
+    unboxInteger(Reg::RCX);
+    a.cmp(Reg::RCX, reg);
+    a.j(Condition::NE, overflow);
+    a.shl(reg, 16);
+    a.shr(reg, 16);
+    a.or_(reg, Reg::R14);
+}
+
+void JitCompiler::toDouble(Reg value, Kind kind, Xmm dst, Label fail) {
+    X86Assembler& a = assembler;
+    if (kind == FLOAT) {
+        a.movq(dst, value);
+        return;
+    }
+    if (kind == SMALL_INT) {
+        a.mov(Reg::RCX, value);
+        unboxInteger(Reg::RCX);
+        a.cvtsi2sd(dst, Reg::RCX);
+        return;
+    }
+
+    Label not_integer = a.newLabel();
+    Label done = a.newLabel();
+    branchIfNotSmallInteger(value, not_integer);
+    a.mov(Reg::RCX, value);
+    unboxInteger(Reg::RCX);
+    a.cvtsi2sd(dst, Reg::RCX);
+    a.jmp(done);
+    a.bind(not_integer);
+    a.cmp(value, Reg::R13);
+    a.j(Condition::AE, fail);
+    a.movq(dst, value);
+    a.bind(done);
+}
+
+void JitCompiler::emitColdPaths() {
+    X86Assembler& a = assembler;
+    for (const ColdPath& path : cold_paths) {
+        a.bind(path.label);
+        if (path.release) {
+            a.lea(Reg::RDI, path.slot);
+            a.call(release_routine);
+            a.jmp(path.resume);
+        } else {
+            a.mov32(Reg::RAX, path.pc);
+            a.jmp(exit_label);
+        }
+    }
+
+    // Called with the slot in rdi. The five saved registers and the return
+    // address leave the stack 16-byte aligned after pushing rax.
+    a.bind(release_routine);
+    a.push(Reg::RAX);
+    a.mov(Reg::RAX, reinterpret_cast<uint64_t>(&releaseSlot));
+    a.call(Reg::RAX);
+    a.pop(Reg::RAX);
+    a.ret();
+}
+
+void JitCompiler::compileLoadConst(const Instruction& ins) {
+    const Value& constant = chunk.constants[ins.b];
+    assembler.mov(Reg::RAX, constant.raw());
+    storeResult(ins.a, constant.isSmallInteger() ? SMALL_INT : constant.isFloat() ? FLOAT : IMMEDIATE);
+}
+
+void JitCompiler::compileGetVar(const Instruction& ins, size_t pc) {
+    X86Assembler& a = assembler;
+    uint32_t slot = ins.b;
+    Kind kind = variable_kinds[slot];
+    if (kind != UNKNOWN) {
+        // Guarded or stored earlier in this region
+        a.mov(Reg::RAX, variableField(slot, offsetof(Variable, value)));
+        storeResult(ins.a, kind);
+        return;
+    }
+
+    Label bail = bailout(pc);
+    // Uninitialized reads raise an error; heap values need a retain
+    a.cmp8(variableField(slot, offsetof(Variable, is_initialized)), 0);
+    a.j(Condition::E, bail);
+    a.mov(Reg::RAX, variableField(slot, offsetof(Variable, value)));
+    const Value& current = variables[slot].value;
+    if (current.isSmallInteger()) {
+        branchIfNotSmallInteger(Reg::RAX, bail);
+        kind = SMALL_INT;
+    } else if (current.isFloat()) {
+        a.cmp(Reg::RAX, Reg::R13);
+        a.j(Condition::AE, bail);
+        kind = FLOAT;
+    } else {
+        a.cmp(Reg::RAX, Reg::R15);
+        a.j(Condition::AE, bail);
+        kind = IMMEDIATE;
+    }
+    variable_kinds[slot] = kind;
+    touched_variables.push_back(slot);
+    storeResult(ins.a, kind);
+}
+
+void JitCompiler::compileSetVar(const Instruction& ins, size_t pc) {
+    X86Assembler& a = assembler;
+    uint32_t slot = ins.b;
+    Kind kind = kinds[ins.a];
+    bool checked = writable[slot];
+    if (!checked || kind == UNKNOWN) {
+        Label bail = bailout(pc);
+        if (!checked) {
+            // Undefined and fixed variables go through Environment::assign
+            a.cmp8(variableField(slot, offsetof(Variable, is_defined)), 0);
+            a.j(Condition::E, bail);
+            a.cmp8(variableField(slot, offsetof(Variable, is_constant)), 0);
+            a.j(Condition::NE, bail);
+        }
+        a.mov(Reg::RAX, registerSlot(ins.a));
+        if (kind == UNKNOWN) {
+            a.cmp(Reg::RAX, Reg::R15);
+            a.j(Condition::AE, bail);
+            kind = IMMEDIATE;
+        }
+    } else {
+        a.mov(Reg::RAX, registerSlot(ins.a));
+    }
+
+    if (variable_kinds[slot] == UNKNOWN) {
+        releaseHeapValue(variableField(slot, offsetof(Variable, value)));
+        a.mov8(variableField(slot, offsetof(Variable, is_initialized)), 1);
+        touched_variables.push_back(slot);
+    }
+    a.mov(variableField(slot, offsetof(Variable, value)), Reg::RAX);
+    variable_kinds[slot] = kind;
+    writable[slot] = true;
+}
+
+void JitCompiler::compileArithmetic(const Instruction& ins, size_t pc) {
+    X86Assembler& a = assembler;
+    Label bail = bailout(pc);
+    Label floating = a.newLabel();
+    Label done = a.newLabel();
+
+    Kind left = kinds[ins.b];
+    Kind right = kinds[ins.c];
+    bool both_integers = left == SMALL_INT && right == SMALL_INT;
+    bool float_operand = left == FLOAT || right == FLOAT;
+    if (ins.types.known()) {
+        float_operand = float_operand || ins.types.left() == ValueType::FLOAT ||
+                        ins.types.right() == ValueType::FLOAT;
+    }
+    bool known_integers = both_integers ||
+        (ins.types.known() && ins.types.left() == ValueType::INTEGER && ins.types.right() == ValueType::INTEGER);
+    bool truncating = ins.op == OpCode::INT_DIV || ins.op == OpCode::MODULO;
+
+    bool integer_path = ins.op != OpCode::DIVIDE && !float_operand;
+    bool float_path = !truncating && (ins.op == OpCode::DIVIDE || !known_integers);
+
+    if (!integer_path && !float_path) {
+        // A float reached '//' or '%'; the interpreter truncates it
+        a.jmp(bail);
+        storeResult(ins.a, UNKNOWN);
+        return;
+    }
+
+    a.mov(Reg::RAX, registerSlot(ins.b));
+    a.mov(Reg::RDX, registerSlot(ins.c));
+
+    if (integer_path) {
+        Label not_integer = float_path ? floating : bail;
+        if (left != SMALL_INT) branchIfNotSmallInteger(Reg::RAX, not_integer);
+        if (right != SMALL_INT) branchIfNotSmallInteger(Reg::RDX, not_integer);
+        if (truncating) {
+            unboxInteger(Reg::RAX);
+            unboxInteger(Reg::RDX);
+            // Both truncate, as idiv does
+            a.test(Reg::RDX, Reg::RDX);
+            a.j(Condition::E, bail);
+            a.mov(Reg::RCX, Reg::RDX);
+            a.cqo();
+            a.idiv(Reg::RCX);
+            if (ins.op == OpCode::MODULO) {
+                a.mov(Reg::RAX, Reg::RDX);
+            }
+            boxInteger(Reg::RAX, bail);
+        } else {
+            // With payloads in the top 48 bits the overflow flag reports
+            // exactly the results that need a BigInt
+            a.shl(Reg::RAX, 16);
+            a.shl(Reg::RDX, 16);
+            switch (ins.op) {
+                case OpCode::ADD:      a.add(Reg::RAX, Reg::RDX); break;
+                case OpCode::SUBTRACT: a.sub(Reg::RAX, Reg::RDX); break;
+                default:
+                    a.sar(Reg::RAX, 16);
+                    a.imul(Reg::RAX, Reg::RDX);
+                    break;
+            }
+            a.j(Condition::O, bail);
+            a.shr(Reg::RAX, 16);
+            a.or_(Reg::RAX, Reg::R14);
+        }
+        if (float_path) {
+            a.jmp(done);
+        }
+    }
+
+    if (float_path) {
+        a.bind(floating);
+        toDouble(Reg::RAX, left, Xmm::XMM0, bail);
+        toDouble(Reg::RDX, right, Xmm::XMM1, bail);
+        switch (ins.op) {
+            case OpCode::ADD:      a.addsd(Xmm::XMM0, Xmm::XMM1); break;
+            case OpCode::SUBTRACT: a.subsd(Xmm::XMM0, Xmm::XMM1); break;
+            case OpCode::MULTIPLY: a.mulsd(Xmm::XMM0, Xmm::XMM1); break;
+            default: {
+                // Zero divisors raise "Division by zero"; NaN is unordered, not zero
+                Label nonzero = a.newLabel();
+                a.xorpd(Xmm::XMM2, Xmm::XMM2);
+                a.ucomisd(Xmm::XMM1, Xmm::XMM2);
+                a.j(Condition::P, nonzero);
+                a.j(Condition::E, bail);
+                a.bind(nonzero);
+                a.divsd(Xmm::XMM0, Xmm::XMM1);
+                break;
+            }
+        }
+        a.movq(Reg::RAX, Xmm::XMM0);
+        // NaN results use the canonical encoding, as Value(double) does
+        a.ucomisd(Xmm::XMM0, Xmm::XMM0);
+        a.j(Condition::NP, done);
+        a.mov(Reg::RAX, Value::CANONICAL_NAN);
+    }
+
+    a.bind(done);
+    Kind result = IMMEDIATE;
+    if (!float_path) {
+        result = SMALL_INT;
+    } else if (!integer_path) {
+        result = FLOAT;
+    }
+    storeResult(ins.a, result);
+}
+
+Jit::Jit(const Chunk& chunk) : chunk(chunk) {
+    size_t count = chunk.code.size();
+    for (size_t pc = 0; pc < count;) {
+        if (!JitCompiler::isEligible(chunk, pc)) {
+            ++pc;
+            continue;
+        }
+        size_t end = pc + 1;
+        while (end < count && JitCompiler::isEligible(chunk, end)) {
+            ++end;
+        }
+        if (end - pc >= MIN_REGION) {
+            regions.push_back(Region{static_cast<uint32_t>(pc), static_cast<uint32_t>(end)});
+        }
+        pc = end;
+    }
+}
+
+Jit::~Jit() {
+    if (memory) {
+        munmap(memory, mapped_size);
+    }
+}
+
+size_t Jit::nextRegion(size_t pc) {
+    size_t index = cursor;
+    while (index < regions.size() && regions[index].start < pc) {
+        ++index;
+    }
+    return index < regions.size() ? regions[index].start : NO_REGION;
+}
+
+size_t Jit::run(size_t pc, Value* registers, Variable* variables) {
+    while (regions[cursor].start < pc) {
+        ++cursor;
+    }
+    if (cursor >= batch_end) {
+        compileBatch(variables);
+    }
+    if (!regions[cursor].entry) {
+        return pc; // could not map executable memory; interpret instead
+    }
+    return regions[cursor++].entry(registers, variables);
+}
+
+void Jit::compileBatch(const Variable* variables) {
+    if (!compiler) {
+        compiler = std::make_unique<JitCompiler>(chunk);
+    }
+    compiler->reset();
+
+    std::vector<size_t> offsets;
+    batch_end = cursor;
+    do {
+        offsets.push_back(compiler->compileRegion(regions[batch_end].start, regions[batch_end].end, variables));
+        ++batch_end;
+    } while (batch_end < regions.size() && compiler->size() < BATCH_BYTES);
+    const std::vector<uint8_t>& code = compiler->finish();
+    compiled_bytes += code.size();
+
+    // The mapping is never writable and executable at the same time
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t needed = (code.size() + page - 1) / page * page;
+    bool writable;
+    if (needed > mapped_size) {
+        if (memory) {
+            munmap(memory, mapped_size);
+        }
+        void* mapping = mmap(nullptr, needed, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        memory = mapping == MAP_FAILED ? nullptr : mapping;
+        mapped_size = memory ? needed : 0;
+        writable = memory != nullptr;
+    } else {
+        writable = mprotect(memory, mapped_size, PROT_READ | PROT_WRITE) == 0;
+    }
+
+    bool executable = false;
+    if (writable) {
+        std::memcpy(memory, code.data(), code.size());
+        executable = mprotect(memory, mapped_size, PROT_READ | PROT_EXEC) == 0;
+    }
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        regions[cursor + i].entry = executable
+            ? reinterpret_cast<Entry>(static_cast<uint8_t*>(memory) + offsets[i])
+            : nullptr;
+    }
+}
+
+#else
+
+Jit::Jit(const Chunk& chunk) : chunk(chunk) {}
+
+Jit::~Jit() = default;
+
+size_t Jit::nextRegion(size_t) {
+    return NO_REGION;
+}
+
+size_t Jit::run(size_t pc, Value*, Variable*) {
+    return pc;
+}
+
+void Jit::compileBatch(const Variable*) {}
+
+#endif
+
+} // namespace Lizard
@@ -0,0 +1,228 @@
+#include "x86_assembler.h"
+#include <cstring>
+
+namespace Lizard {
+
+namespace {
+
+unsigned number(Reg reg) { return static_cast<unsigned>(reg); }
+unsigned number(Xmm reg) { return static_cast<unsigned>(reg); }
+
+} // namespace
+
+X86Assembler::Label X86Assembler::newLabel() {
+    label_offsets.push_back(-1);
+    return static_cast<Label>(label_offsets.size() - 1);
+}
+
+void X86Assembler::bind(Label label) {
+    label_offsets[label] = static_cast<int64_t>(bytes.size());
+}
+
+void X86Assembler::finish() {
+    for (const Fixup& fixup : fixups) {
+        int32_t rel = static_cast<int32_t>(label_offsets[fixup.target] - static_cast<int64_t>(fixup.offset + 4));
+        std::memcpy(&bytes[fixup.offset], &rel, sizeof(rel));
+    }
+    fixups.clear();
+}
+
+void X86Assembler::clear() {
+    bytes.clear();
+    label_offsets.clear();
+    fixups.clear();
+}
+
+void X86Assembler::imm32(uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        byte(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+void X86Assembler::rex(bool wide, unsigned reg, unsigned base) {
+    uint8_t prefix = 0x40 | (wide ? 0x08 : 0) | ((reg & 8) ? 0x04 : 0) | ((base & 8) ? 0x01 : 0);
+    if (prefix != 0x40) {
+        byte(prefix);
+    }
+}
+
+void X86Assembler::modrm(unsigned reg, Reg rm) {
+    byte(static_cast<uint8_t>(0xC0 | ((reg & 7) << 3) | (number(rm) & 7)));
+}
+
+void X86Assembler::modrm(unsigned reg, Mem mem) {
+    bool short_disp = mem.disp >= INT8_MIN && mem.disp <= INT8_MAX;
+    byte(static_cast<uint8_t>((short_disp ? 0x40 : 0x80) | ((reg & 7) << 3) | (number(mem.base) & 7)));
+    if ((number(mem.base) & 7) == 4) {
+        byte(0x24); // SIB: base only, needed for rsp and r12
+    }
+    if (short_disp) {
+        byte(static_cast<uint8_t>(mem.disp));
+    } else {
+        imm32(static_cast<uint32_t>(mem.disp));
+    }
+}
+
+void X86Assembler::push(Reg reg) {
+    rex(false, 0, number(reg));
+    byte(static_cast<uint8_t>(0x50 + (number(reg) & 7)));
+}
+
+void X86Assembler::pop(Reg reg) {
+    rex(false, 0, number(reg));
+    byte(static_cast<uint8_t>(0x58 + (number(reg) & 7)));
+}
+
+void X86Assembler::call(Reg target) {
+    rex(false, 0, number(target));
+    byte(0xFF);
+    modrm(2, target);
+}
+
+void X86Assembler::call(Label target) {
+    byte(0xE8);
+    rel32(target);
+}
+
+void X86Assembler::mov(Reg dst, Reg src) {
+    alu(0x89, dst, src);
+}
+
+void X86Assembler::mov(Reg dst, Mem src) {
+    rex(true, number(dst), number(src.base));
+    byte(0x8B);
+    modrm(number(dst), src);
+}
+
+void X86Assembler::mov(Mem dst, Reg src) {
+    rex(true, number(src), number(dst.base));
+    byte(0x89);
+    modrm(number(src), dst);
+}
+
+void X86Assembler::mov(Reg dst, uint64_t imm) {
+    rex(true, 0, number(dst));
+    byte(static_cast<uint8_t>(0xB8 + (number(dst) & 7)));
+    imm32(static_cast<uint32_t>(imm));
+    imm32(static_cast<uint32_t>(imm >> 32));
+}
+
+void X86Assembler::mov32(Reg dst, uint32_t imm) {
+    rex(false, 0, number(dst));
+    byte(static_cast<uint8_t>(0xB8 + (number(dst) & 7)));
+    imm32(imm);
+}
+
+void X86Assembler::mov8(Mem dst, uint8_t imm) {
+    rex(false, 0, number(dst.base));
+    byte(0xC6);
+    modrm(0, dst);
+    byte(imm);
+}
+
+void X86Assembler::lea(Reg dst, Mem src) {
+    rex(true, number(dst), number(src.base));
+    byte(0x8D);
+    modrm(number(dst), src);
+}
+
+void X86Assembler::alu(uint8_t opcode, Reg dst, Reg src) {
+    rex(true, number(src), number(dst));
+    byte(opcode);
+    modrm(number(src), dst);
+}
+
+void X86Assembler::aluImm8(unsigned extension, Reg dst, int8_t imm) {
+    rex(true, 0, number(dst));
+    byte(0x83);
+    modrm(extension, dst);
+    byte(static_cast<uint8_t>(imm));
+}
+
+void X86Assembler::imul(Reg dst, Reg src) {
+    rex(true, number(dst), number(src));
+    byte(0x0F);
+    byte(0xAF);
+    modrm(number(dst), src);
+}
+
+void X86Assembler::cqo() {
+    byte(0x48);
+    byte(0x99);
+}
+
+void X86Assembler::idiv(Reg divisor) {
+    rex(true, 0, number(divisor));
+    byte(0xF7);
+    modrm(7, divisor);
+}
+
+void X86Assembler::cmp32(Reg a, uint32_t imm) {
+    rex(false, 0, number(a));
+    byte(0x81);
+    modrm(7, a);
+    imm32(imm);
+}
+
+void X86Assembler::cmp8(Mem a, uint8_t imm) {
+    rex(false, 0, number(a.base));
+    byte(0x80);
+    modrm(7, a);
+    byte(imm);
+}
+
+void X86Assembler::shift(unsigned extension, Reg reg, uint8_t count) {
+    rex(true, 0, number(reg));
+    byte(0xC1);
+    modrm(extension, reg);
+    byte(count);
+}
+
+void X86Assembler::movq(Xmm dst, Reg src) {
+    byte(0x66);
+    rex(true, number(dst), number(src));
+    byte(0x0F);
+    byte(0x6E);
+    modrm(number(dst), src);
+}
+
+void X86Assembler::movq(Reg dst, Xmm src) {
+    byte(0x66);
+    rex(true, number(src), number(dst));
+    byte(0x0F);
+    byte(0x7E);
+    modrm(number(src), dst);
+}
+
+void X86Assembler::cvtsi2sd(Xmm dst, Reg src) {
+    byte(0xF2);
+    rex(true, number(dst), number(src));
+    byte(0x0F);
+    byte(0x2A);
+    modrm(number(dst), src);
+}
+
+void X86Assembler::sse(uint8_t prefix, uint8_t opcode, Xmm dst, Xmm src) {
+    byte(prefix);
+    byte(0x0F);
+    byte(opcode);
+    byte(static_cast<uint8_t>(0xC0 | (number(dst) << 3) | number(src)));
+}
+
+void X86Assembler::jmp(Label target) {
+    byte(0xE9);
+    rel32(target);
+}
+
+void X86Assembler::j(Condition condition, Label target) {
+    byte(0x0F);
+    byte(static_cast<uint8_t>(0x80 | static_cast<uint8_t>(condition)));
+    rel32(target);
+}
+
+void X86Assembler::rel32(Label target) {
+    fixups.push_back(Fixup{bytes.size(), target});
+    imm32(0);
+}
+
+} // namespace Lizard
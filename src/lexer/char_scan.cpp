@@ -0,0 +1,222 @@
+#include "char_scan.h"
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define LIZARD_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace Lizard {
+
+namespace CharScan {
+
+namespace {
+
+const char* findNewlineScalar(const char* begin, const char* end) {
+    const void* found = std::memchr(begin, '\n', static_cast<size_t>(end - begin));
+    return found ? static_cast<const char*>(found) : end;
+}
+
+const char* skipBlanksScalar(const char* begin, const char* end) {
+    while (begin < end && isBlank(*begin)) {
+        begin++;
+    }
+    return begin;
+}
+
+const char* skipIdentifierScalar(const char* begin, const char* end) {
+    while (begin < end && isIdentifierChar(*begin)) {
+        begin++;
+    }
+    return begin;
+}
+
+const char* findStringSpecialScalar(const char* begin, const char* end) {
+    while (begin < end && *begin != '"' && *begin != '\\' && *begin != '\n') {
+        begin++;
+    }
+    return begin;
+}
+
+#ifdef LIZARD_SCAN_X86
+
+// Each vector kernel builds a mask of the bytes that end the run, returns
+// at the first one and leaves the final partial block to the scalar loop.
+// The class tests mirror the inline predicates: an unsigned range check
+// `x - lo < n` is done as a signed compare after flipping the sign bit.
+
+inline __m128i inRange128(__m128i bytes, char lo, char count) {
+    __m128i shifted = _mm_xor_si128(_mm_sub_epi8(bytes, _mm_set1_epi8(lo)), _mm_set1_epi8(char(0x80)));
+    return _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(count - 128)));
+}
+
+inline __m128i blanks128(__m128i bytes) {
+    __m128i controls = _mm_andnot_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n')),
+                                        inRange128(bytes, '\t', 5));
+    return _mm_or_si128(controls, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')));
+}
+
+inline __m128i identifier128(__m128i bytes) {
+    __m128i alpha = inRange128(_mm_or_si128(bytes, _mm_set1_epi8(0x20)), 'a', 26);
+    __m128i digit = inRange128(bytes, '0', 10);
+    __m128i underscore = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('_'));
+    return _mm_or_si128(_mm_or_si128(alpha, digit), underscore);
+}
+
+const char* findNewlineSse2(const char* begin, const char* end) {
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; end - begin >= 16; begin += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline)));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+    }
+    return findNewlineScalar(begin, end);
+}
+
+const char* skipBlanksSse2(const char* begin, const char* end) {
+    for (; end - begin >= 16; begin += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(blanks128(bytes))) & 0xFFFF;
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+    }
+    return skipBlanksScalar(begin, end);
+}
+
+const char* skipIdentifierSse2(const char* begin, const char* end) {
+    for (; end - begin >= 16; begin += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(identifier128(bytes))) & 0xFFFF;
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+    }
+    return skipIdentifierScalar(begin, end);
+}
+
+const char* findStringSpecialSse2(const char* begin, const char* end) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; end - begin >= 16; begin += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, quote), _mm_cmpeq_epi8(bytes, backslash)),
+                                       _mm_cmpeq_epi8(bytes, newline));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+    }
+    return findStringSpecialScalar(begin, end);
+}
+
+__attribute__((target("avx2")))
+inline __m256i inRange256(__m256i bytes, char lo, char count) {
+    __m256i shifted = _mm256_xor_si256(_mm256_sub_epi8(bytes, _mm256_set1_epi8(lo)), _mm256_set1_epi8(char(0x80)));
+    return _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(count - 128)), shifted);
+}
+
+__attribute__((target("avx2")))
+const char* findNewlineAvx2(const char* begin, const char* end) {
+    const __m256i newline = _mm256_set1_epi8('\n');
+    for (; end - begin >= 32; begin += 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, newline)));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+    }
+    return findNewlineSse2(begin, end);
+}
+
+__attribute__((target("avx2")))
+const char* skipBlanksAvx2(const char* begin, const char* end) {
+    for (; end - begin >= 32; begin += 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        __m256i controls = _mm256_andnot_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n')),
+                                               inRange256(bytes, '\t', 5));
+        __m256i blanks = _mm256_or_si256(controls, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' ')));
+        unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(blanks));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+    }
+    return skipBlanksSse2(begin, end);
+}
+
+__attribute__((target("avx2")))
+const char* skipIdentifierAvx2(const char* begin, const char* end) {
+    for (; end - begin >= 32; begin += 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        __m256i alpha = inRange256(_mm256_or_si256(bytes, _mm256_set1_epi8(0x20)), 'a', 26);
+        __m256i digit = inRange256(bytes, '0', 10);
+        __m256i underscore = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('_'));
+        __m256i word = _mm256_or_si256(_mm256_or_si256(alpha, digit), underscore);
+        unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(word));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+    }
+    return skipIdentifierSse2(begin, end);
+}
+
+__attribute__((target("avx2")))
+const char* findStringSpecialAvx2(const char* begin, const char* end) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    for (; end - begin >= 32; begin += 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        __m256i special = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(bytes, quote),
+                                                          _mm256_cmpeq_epi8(bytes, backslash)),
+                                          _mm256_cmpeq_epi8(bytes, newline));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(special));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+    }
+    return findStringSpecialSse2(begin, end);
+}
+
+bool hasAvx2() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+const bool use_avx2 = hasAvx2();
+
+#endif // LIZARD_SCAN_X86
+
+} // namespace
+
+#ifdef LIZARD_SCAN_X86
+
+// SSE2 is part of x86-64, so only AVX2 needs checking
+const Kernel findNewline = use_avx2 ? findNewlineAvx2 : findNewlineSse2;
+const Kernel skipBlanks = use_avx2 ? skipBlanksAvx2 : skipBlanksSse2;
+const Kernel skipIdentifier = use_avx2 ? skipIdentifierAvx2 : skipIdentifierSse2;
+const Kernel findStringSpecial = use_avx2 ? findStringSpecialAvx2 : findStringSpecialSse2;
+
+const char* implementation() {
+    return use_avx2 ? "avx2" : "sse2";
+}
+
+#else
+
+const Kernel findNewline = findNewlineScalar;
+const Kernel skipBlanks = skipBlanksScalar;
+const Kernel skipIdentifier = skipIdentifierScalar;
+const Kernel findStringSpecial = findStringSpecialScalar;
+
+const char* implementation() {
+    return "scalar";
+}
+
+#endif
+
+} // namespace CharScan
+
+} // namespace Lizard
@@ -1,63 +1,80 @@
 #include "lexer.h"
-#include "error_handler.h"
 #include "lexer_string.h"
 #include "lexer_number.h"
 #include "lexer_identifier.h"
-#include "lexer_arithmetic.h"
-#include <cctype>
+#include "lexer_operator.h"
+#include "lexer_table.h"
 
 namespace Lizard {
 
-Lexer::Lexer(const std::string& source, const std::string& filename)
-    : state(source, filename) {}
+Lexer::Lexer(std::string_view source, uint32_t file, Diagnostics& diagnostics)
+    : state(source, file, diagnostics) {}
 
-std::vector<Token> Lexer::tokenize() {
-    std::vector<Token> tokens;
+Lexer::Lexer(SourceStream& stream, uint32_t file, Diagnostics& diagnostics)
+    : state(stream, file, diagnostics) {}
+
+TokenList Lexer::tokenize() {
+    TokenList list;
+    list.source = state.getSource();
+    list.file = state.getFile();
+    
+    std::vector<Token>& tokens = list.tokens;
+    // A first guess that costs at most twice the source; dense code grows
+    // past it, while comments and long strings would otherwise leave most
+    // of a bigger reservation unused
+    tokens.reserve(list.source.size() / 8 + 1);
     
-    while (!state.isAtEnd()) {
-        while (!state.isAtEnd() && (std::isspace(state.peek()) || state.peek() == '#')) {
-            if (state.peek() == '#') {
+    do {
+        tokens.push_back(next());
+    } while (tokens.back().type != TokenType::EOF_TOKEN);
+    
+    list.decoded = std::move(state.decoded);
+    return list;
+}
+
+Token Lexer::next() {
+    while (!state.isAtEnd() && !state.shouldStop()) {
+        char c = state.peek();
+        LexerState::Mark start = state.mark();
+        
+        switch (LexerTable::classOf(c)) {
+            case LexerTable::CharClass::BLANK:
+                state.skipWhitespace();
+                continue;
+            case LexerTable::CharClass::COMMENT:
                 state.skipComment();
-            } else if (state.peek() == '\n') {
-                tokens.emplace_back(TokenType::NEWLINE, "\n", state.getCurrentPosition());
+                continue;
+            case LexerTable::CharClass::NEWLINE:
                 state.advance();
-            } else {
-                state.skipWhitespace();
+                return state.tokenFrom(start, TokenType::NEWLINE);
+            case LexerTable::CharClass::QUOTE:
+                if (state.peekNext() == '"' && state.peekNext(2) == '"') {
+                    return parseMultilineString(state);
+                }
+                return parseString(state);
+            case LexerTable::CharClass::DIGIT:
+                return parseNumber(state);
+            case LexerTable::CharClass::IDENTIFIER:
+                return parseIdentifier(state);
+            case LexerTable::CharClass::OPERATOR: {
+                TokenType type = parseOperator(state);
+                if (type != TokenType::EOF_TOKEN) {
+                    return state.tokenFrom(start, type);
+                }
+                break;
             }
+            case LexerTable::CharClass::INVALID:
+                break;
         }
         
-        if (state.isAtEnd()) break;
-        
-        char c = state.peek();
-        
-        if (c == '"') {
-            if (state.peekNext() == '"' && state.peekNext(2) == '"') {
-                tokens.push_back(parseMultilineString(state));
-            } else {
-                tokens.push_back(parseString(state));
-            }
-        } else if (std::isdigit(c)) {
-            tokens.push_back(parseNumber(state));
-        } else if (std::isalpha(c) || c == '_') {
-            tokens.push_back(parseIdentifier(state));
-        } else if (c == '=') {
-            tokens.emplace_back(TokenType::ASSIGN, "=", state.getCurrentPosition());
-            state.advance();
-        } else if (c == '+' || c == '-' || c == '*' || c == '/' || c == '%') {
-            tokens.push_back(parseArithmeticOperator(state));
-        } else if (c == '(') {
-            tokens.emplace_back(TokenType::LEFT_PAREN, "(", state.getCurrentPosition());
-            state.advance();
-        } else if (c == ')') {
-            tokens.emplace_back(TokenType::RIGHT_PAREN, ")", state.getCurrentPosition());
-            state.advance();
-        } else {
-            ErrorHandler::reportError("Unexpected character '" + std::string(1, c) + "'", state.getCurrentPosition());
-        }
+        // The parser fails at the ERROR token, where its error is
+        // dropped as a duplicate of this one
+        state.error("Unexpected character '" + std::string(1, c) + "'", state.positionOf(start));
+        state.advance();
+        return state.tokenFrom(start, TokenType::ERROR);
     }
     
-    tokens.emplace_back(TokenType::EOF_TOKEN, "", state.getCurrentPosition());
-    return tokens;
+    return state.tokenFrom(state.mark(), TokenType::EOF_TOKEN);
 }
 
-} // namespace Lizard
\ No newline at end of file
+} // namespace Lizard
@@ -1,20 +1,15 @@
 #include "lexer_identifier.h"
 #include "lexer_keywords.h"
-#include <cctype>
 
 namespace Lizard {
 
 Token parseIdentifier(LexerState& state) {
-    Position start_pos = state.getCurrentPosition();
-    std::string value;
+    LexerState::Mark start = state.mark();
     
-    while (!state.isAtEnd() && (std::isalnum(state.peek()) || state.peek() == '_')) {
-        value += state.advance();
-    }
+    state.skipRun(CharScan::skipIdentifier);
     
-    TokenType type = getKeywordType(value);
-    
-    return Token(type, value, start_pos);
+    std::string_view value = state.getSource().substr(start.offset, state.getOffset() - start.offset);
+    return state.tokenFrom(start, getKeywordType(value));
 }
 
-} // namespace Lizard
\ No newline at end of file
+} // namespace Lizard
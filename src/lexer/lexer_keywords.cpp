@@ -1,23 +1,98 @@
 #include "lexer_keywords.h"
-#include <unordered_map>
+#include "lexer_table.h"
+#include <array>
+#include <cstdint>
 
 namespace Lizard {
 
-static std::unordered_map<std::string, TokenType> keywords = {
+namespace {
+
+constexpr LexerTable::Spelling keywords[] = {
     {"put", TokenType::PUT},       {"var", TokenType::VAR},
     {"fix", TokenType::FIX},       {"true", TokenType::BOOLEAN},
     {"false", TokenType::BOOLEAN}, {"nil", TokenType::NIL}};
 
-TokenType getKeywordType(const std::string &identifier) {
-  auto it = keywords.find(identifier);
-  if (it != keywords.end()) {
-    return it->second;
+constexpr size_t KEYWORD_COUNT = sizeof(keywords) / sizeof(keywords[0]);
+
+// Power of two with room to spare, so a collision-free seed is easy to find
+constexpr size_t SLOT_COUNT = [] {
+  size_t slots = 1;
+  while (slots < 2 * KEYWORD_COUNT) {
+    slots *= 2;
+  }
+  return slots;
+}();
+
+constexpr size_t MIN_LENGTH = [] {
+  size_t length = SIZE_MAX;
+  for (const LexerTable::Spelling& keyword : keywords) {
+    length = keyword.text.size() < length ? keyword.text.size() : length;
+  }
+  return length;
+}();
+
+constexpr size_t MAX_LENGTH = [] {
+  size_t length = 0;
+  for (const LexerTable::Spelling& keyword : keywords) {
+    length = keyword.text.size() > length ? keyword.text.size() : length;
+  }
+  return length;
+}();
+
+// Looks only at the length and the first and last bytes; `text` is not empty
+constexpr size_t slotOf(std::string_view text, uint32_t seed) {
+  uint32_t first = static_cast<unsigned char>(text.front());
+  uint32_t last = static_cast<unsigned char>(text.back());
+  return ((first * seed) ^ (last + static_cast<uint32_t>(text.size()) * 31)) & (SLOT_COUNT - 1);
+}
+
+// The smallest seed that gives every keyword its own slot, or 0 if none does
+constexpr uint32_t findSeed() {
+  for (uint32_t seed = 1; seed < 4096; ++seed) {
+    bool taken[SLOT_COUNT] = {};
+    bool unique = true;
+    for (const LexerTable::Spelling& keyword : keywords) {
+      size_t slot = slotOf(keyword.text, seed);
+      unique = unique && !taken[slot];
+      taken[slot] = true;
+    }
+    if (unique) {
+      return seed;
+    }
+  }
+  return 0;
+}
+
+constexpr uint32_t SEED = findSeed();
+static_assert(SEED != 0, "no perfect hash for the keyword table; widen the search or the slots");
+
+// Index into `keywords` for each slot, or -1 if empty
+constexpr std::array<int8_t, SLOT_COUNT> slots = [] {
+  std::array<int8_t, SLOT_COUNT> table{};
+  for (int8_t& entry : table) {
+    entry = -1;
+  }
+  for (size_t i = 0; i < KEYWORD_COUNT; ++i) {
+    table[slotOf(keywords[i].text, SEED)] = static_cast<int8_t>(i);
+  }
+  return table;
+}();
+
+} // namespace
+
+TokenType getKeywordType(std::string_view identifier) {
+  if (identifier.size() < MIN_LENGTH || identifier.size() > MAX_LENGTH) {
+    return TokenType::IDENTIFIER;
+  }
+  int8_t index = slots[slotOf(identifier, SEED)];
+  if (index >= 0 && keywords[index].text == identifier) {
+    return keywords[index].type;
   }
   return TokenType::IDENTIFIER;
 }
 
-bool isKeyword(const std::string &identifier) {
-  return keywords.find(identifier) != keywords.end();
+bool isKeyword(std::string_view identifier) {
+  return getKeywordType(identifier) != TokenType::IDENTIFIER;
 }
 
 } // namespace Lizard
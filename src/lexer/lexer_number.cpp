@@ -1,27 +1,26 @@
 #include "lexer_number.h"
-#include <cctype>
+#include "char_scan.h"
 
 namespace Lizard {
 
 Token parseNumber(LexerState& state) {
-    Position start_pos = state.getCurrentPosition();
-    std::string value;
+    LexerState::Mark start = state.mark();
     
-    while (!state.isAtEnd() && std::isdigit(state.peek())) {
-        value += state.advance();
+    while (!state.isAtEnd() && CharScan::isDigit(state.peek())) {
+        state.advance();
     }
     
     bool is_float = false;
-    if (!state.isAtEnd() && state.peek() == '.' && std::isdigit(state.peekNext())) {
+    if (!state.isAtEnd() && state.peek() == '.' && CharScan::isDigit(state.peekNext())) {
         is_float = true;
-        value += state.advance(); // consume '.'
+        state.advance(); // consume '.'
         
-        while (!state.isAtEnd() && std::isdigit(state.peek())) {
-            value += state.advance();
+        while (!state.isAtEnd() && CharScan::isDigit(state.peek())) {
+            state.advance();
         }
     }
     
-    return Token(is_float ? TokenType::FLOAT : TokenType::INTEGER, value, start_pos);
+    return state.tokenFrom(start, is_float ? TokenType::FLOAT : TokenType::INTEGER);
 }
 
-} // namespace Lizard
\ No newline at end of file
+} // namespace Lizard
@@ -0,0 +1,31 @@
+#include "lexer_operator.h"
+#include "lexer_table.h"
+
+namespace Lizard {
+
+TokenType parseOperator(LexerState& state) {
+    const LexerTable::OperatorDfa& dfa = LexerTable::operator_dfa;
+    
+    // Walk the DFA on lookahead, remembering the last accepting state, so
+    // that nothing is consumed beyond the longest match
+    TokenType type = TokenType::EOF_TOKEN;
+    int length = 0;
+    uint8_t current = 0;
+    for (int i = 0;; ++i) {
+        current = dfa.next[current][static_cast<unsigned char>(state.peekNext(i))];
+        if (current == 0) {
+            break;
+        }
+        if (dfa.accept[current] != TokenType::EOF_TOKEN) {
+            type = dfa.accept[current];
+            length = i + 1;
+        }
+    }
+    
+    for (int i = 0; i < length; ++i) {
+        state.advance();
+    }
+    return type;
+}
+
+} // namespace Lizard
@@ -1,13 +1,62 @@
 #include "lexer_state.h"
-#include <cctype>
+#include <cstring>
 
 namespace Lizard {
 
-LexerState::LexerState(const std::string& source, const std::string& filename)
-    : source(source), filename(filename), current(0), line(1), column(1) {}
+LexerState::LexerState(std::string_view source, uint32_t file, Diagnostics& diagnostics)
+    : source(source), file(file), diagnostics(diagnostics), current(0), line(1), column(1) {}
 
-bool LexerState::isAtEnd() const {
-    return current >= source.length();
+LexerState::LexerState(SourceStream& stream, uint32_t file, Diagnostics& diagnostics)
+    : source(stream.buffered()), stream(&stream), file(file), diagnostics(diagnostics),
+      current(0), line(1), column(1) {}
+
+bool LexerState::refill() {
+    if (!stream) {
+        return false;
+    }
+    // Even a fill that finds nothing may have moved the buffer
+    bool filled = stream->fill();
+    source = stream->buffered();
+    return filled;
+}
+
+void LexerState::discard(size_t count) {
+    stream->discard(count);
+    source = stream->buffered();
+    current -= count;
+    decoded.clear();
+    interned.clear();
+}
+
+size_t LexerState::beginDecoded() {
+    size_t start = decoded.size();
+    decoded.append(sizeof(uint32_t), '\0');
+    return start;
+}
+
+uint32_t LexerState::internDecoded(size_t start) {
+    uint32_t length = static_cast<uint32_t>(decoded.size() - start - sizeof(length));
+    std::memcpy(&decoded[start], &length, sizeof(length));
+    
+    std::string_view text(decoded.data() + start, decoded.size() - start);
+    size_t hash = std::hash<std::string_view>()(text);
+    
+    auto candidates = interned.equal_range(hash);
+    for (auto it = candidates.first; it != candidates.second; ++it) {
+        if (std::string_view(decoded.data() + it->second.first, it->second.second) == text) {
+            decoded.resize(start);
+            return it->second.first;
+        }
+    }
+    
+    interned.emplace(hash, std::make_pair(static_cast<uint32_t>(start), static_cast<uint32_t>(text.size())));
+    return static_cast<uint32_t>(start);
+}
+
+uint32_t LexerState::copyDecoded(std::string_view text) {
+    size_t start = beginDecoded();
+    decoded.append(text);
+    return internDecoded(start);
 }
 
 char LexerState::advance() {
@@ -23,14 +72,16 @@ char LexerState::advance() {
     return c;
 }
 
-char LexerState::peek() const {
+char LexerState::peek() {
     if (isAtEnd()) return '\0';
     return source[current];
 }
 
-char LexerState::peekNext(int offset) const {
-    if (current + offset >= source.length()) {
-        return '\0';
+char LexerState::peekNext(int offset) {
+    while (current + offset >= source.length()) {
+        if (!refill()) {
+            return '\0';
+        }
     }
     return source[current + offset];
 }
@@ -45,19 +96,46 @@ bool LexerState::match(char expected) {
 }
 
 void LexerState::skipWhitespace() {
-    while (!isAtEnd() && std::isspace(peek()) && peek() != '\n') {
-        advance();
-    }
+    skipRun(CharScan::skipBlanks);
 }
 
 void LexerState::skipComment() {
-    while (!isAtEnd() && peek() != '\n') {
-        advance();
+    skipRun(CharScan::findNewline);
+}
+
+void LexerState::skipRun(CharScan::Kernel scan) {
+    // A run that reaches the end of the buffer may go on in the next chunk
+    while (!isAtEnd()) {
+        const char* begin = source.data() + current;
+        const char* end = source.data() + source.size();
+        const char* stop = scan(begin, end);
+        current += static_cast<size_t>(stop - begin);
+        column += static_cast<int>(stop - begin);
+        if (stop != end) {
+            return;
+        }
     }
 }
 
 Position LexerState::getCurrentPosition() const {
-    return Position(filename, line, column);
+    return Position(file, line, column);
+}
+
+Position LexerState::positionOf(const Mark& mark) const {
+    return Position(file, static_cast<int>(mark.line), static_cast<int>(mark.column));
+}
+
+LexerState::Mark LexerState::mark() const {
+    return Mark{static_cast<uint32_t>(current), static_cast<uint32_t>(line), static_cast<uint32_t>(column)};
+}
+
+Token LexerState::tokenFrom(const Mark& start, TokenType type) {
+    size_t length = current - start.offset;
+    if (length > Token::MAX_LENGTH) {
+        return Token(type, copyDecoded(source.substr(start.offset, length)), 0,
+                     start.line, start.column, Token::DECODED);
+    }
+    return Token(type, start.offset, static_cast<uint32_t>(length), start.line, start.column);
 }
 
-} // namespace Lizard
\ No newline at end of file
+} // namespace Lizard
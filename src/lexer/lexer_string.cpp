@@ -1,189 +1,184 @@
 #include "lexer_string.h"
-#include "error_handler.h"
-#include <cctype>
+#include "char_scan.h"
 
 namespace Lizard {
 
-Token parseString(LexerState& state) {
-    Position start_pos = state.getCurrentPosition();
-    state.advance(); // consume opening quote
-    
-    std::string value;
-    while (!state.isAtEnd() && state.peek() != '"') {
-        if (state.peek() == '\n') {
-            ErrorHandler::reportError("Unterminated string", start_pos);
+namespace {
+
+// Collects a string literal's contents. Escape-free literals stay a view of
+// the source. Once an escape is seen, plain text is copied into a record in
+// the lexer's decoded buffer a whole run at a time: everything since the last escape
+// is appended just before the next one and when the literal ends.
+class LiteralBuffer {
+public:
+    explicit LiteralBuffer(LexerState& state)
+        : state(state), content_start(state.getOffset()), pending(content_start) {}
+
+    // Called on the backslash that starts an escape sequence
+    void beginEscape() {
+        if (!escaped) {
+            decoded_start = state.beginDecoded();
+            escaped = true;
         }
-        if (state.peek() == '\\') {
-            state.advance();
-            if (state.isAtEnd()) {
-                ErrorHandler::reportError("Unterminated string", start_pos);
+        flushPending();
+    }
+
+    // Called once the escape sequence has been consumed
+    void endEscape() {
+        pending = state.getOffset();
+    }
+
+    LiteralBuffer& operator+=(char c) {
+        state.decoded += c;
+        return *this;
+    }
+
+    // Token for the literal; the current offset is just past its contents
+    Token finish(const LexerState::Mark& start) {
+        if (escaped) {
+            flushPending();
+            return Token(TokenType::STRING, state.internDecoded(decoded_start), 0,
+                         start.line, start.column, Token::DECODED);
+        }
+        size_t length = state.getOffset() - content_start;
+        if (length > Token::MAX_LENGTH) {
+            return Token(TokenType::STRING, state.copyDecoded(state.getSource().substr(content_start, length)),
+                         0, start.line, start.column, Token::DECODED);
+        }
+        return Token(TokenType::STRING, static_cast<uint32_t>(content_start),
+                     static_cast<uint32_t>(length), start.line, start.column);
+    }
+
+private:
+    LexerState& state;
+    size_t content_start;
+    size_t pending; // start of the plain text not yet copied
+    size_t decoded_start = 0;
+    bool escaped = false;
+
+    void flushPending() {
+        state.decoded.append(state.getSource().substr(pending, state.getOffset() - pending));
+    }
+};
+
+int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Decodes the escape sequence after a backslash that has been consumed;
+// the state is not at the end of input
+void decodeEscape(LexerState& state, LiteralBuffer& value) {
+    char escape_char = state.peek();
+    switch (escape_char) {
+        case 'n': value += '\n'; break;
+        case 't': value += '\t'; break;
+        case 'r': value += '\r'; break;
+        case '\\': value += '\\'; break;
+        case '"': value += '"'; break;
+        case '0': case '1': case '2': case '3':
+        case '4': case '5': case '6': case '7': {
+            int octal_value = 0;
+            int digit_count = 0;
+
+            while (digit_count < 3 && !state.isAtEnd() &&
+                   state.peek() >= '0' && state.peek() <= '7') {
+                octal_value = octal_value * 8 + (state.peek() - '0');
+                state.advance();
+                digit_count++;
             }
-            char escape_char = state.peek();
-            switch (escape_char) {
-                case 'n': value += '\n'; break;
-                case 't': value += '\t'; break;
-                case 'r': value += '\r'; break;
-                case '\\': value += '\\'; break;
-                case '"': value += '"'; break;
-                case '0': case '1': case '2': case '3':
-                case '4': case '5': case '6': case '7': {
-                    int octal_value = 0;
-                    int digit_count = 0;
-
-                    while (digit_count < 3 && !state.isAtEnd() && 
-                           state.peek() >= '0' && state.peek() <= '7') {
-                        octal_value = octal_value * 8 + (state.peek() - '0');
-                        state.advance();
-                        digit_count++;
-                    }
-                    
-                    if (octal_value > 255) {
-                        ErrorHandler::reportError("Octal escape sequence out of range", state.getCurrentPosition());
-                    }
-                    
-                    value += static_cast<char>(octal_value);
-                    continue; // Don't advance again, we already did in the loop
-                }
-                case 'x': {
-                    state.advance(); // consume 'x'
-                    if (state.isAtEnd()) {
-                        ErrorHandler::reportError("Invalid hexadecimal escape sequence", state.getCurrentPosition());
-                    }
-                    
-                    int hex_value = 0;
-                    int digit_count = 0;
-                    
-                    while (digit_count < 2 && !state.isAtEnd()) {
-                        char hex_char = state.peek();
-                        if (hex_char >= '0' && hex_char <= '9') {
-                            hex_value = hex_value * 16 + (hex_char - '0');
-                        } else if (hex_char >= 'a' && hex_char <= 'f') {
-                            hex_value = hex_value * 16 + (hex_char - 'a' + 10);
-                        } else if (hex_char >= 'A' && hex_char <= 'F') {
-                            hex_value = hex_value * 16 + (hex_char - 'A' + 10);
-                        } else {
-                            break;
-                        }
-                        state.advance();
-                        digit_count++;
-                    }
-                    
-                    if (digit_count == 0) {
-                        ErrorHandler::reportError("Invalid hexadecimal escape sequence", state.getCurrentPosition());
-                    }
-                    
-                    value += static_cast<char>(hex_value);
-                    continue; // Don't advance again
-                }
-                default:
-                    ErrorHandler::reportError("Invalid escape sequence", state.getCurrentPosition());
+
+            if (octal_value > 255) {
+                state.error("Octal escape sequence out of range", state.getCurrentPosition());
             }
-        } else {
-            value += state.peek();
+
+            value += static_cast<char>(octal_value);
+            return; // the digits are already consumed
         }
-        state.advance();
-    }
-    
-    if (state.isAtEnd()) {
-        ErrorHandler::reportError("Unterminated string", start_pos);
+        case 'x': {
+            state.advance(); // consume 'x'
+
+            int hex_value = 0;
+            int digit_count = 0;
+
+            while (digit_count < 2 && !state.isAtEnd() && hexDigit(state.peek()) >= 0) {
+                hex_value = hex_value * 16 + hexDigit(state.peek());
+                state.advance();
+                digit_count++;
+            }
+
+            if (digit_count == 0) {
+                state.error("Invalid hexadecimal escape sequence", state.getCurrentPosition());
+            }
+
+            value += static_cast<char>(hex_value);
+            return;
+        }
+        default:
+            state.error("Invalid escape sequence", state.getCurrentPosition());
     }
-    
     state.advance();
-    return Token(TokenType::STRING, value, start_pos);
 }
 
-Token parseMultilineString(LexerState& state) {
-    Position start_pos = state.getCurrentPosition();
-    
-    state.advance();
-    state.advance();
-    state.advance();
+// Shared by both literal forms. `quotes` is 1 for "..." and 3 for
+// """...""", which may also span lines.
+Token decodeString(LexerState& state, int quotes) {
+    LexerState::Mark start = state.mark();
+    Position start_pos = state.positionOf(start);
+    for (int i = 0; i < quotes; ++i) {
+        state.advance(); // opening quotes
+    }
 
-    std::string value;
-    
-    while (!state.isAtEnd()) {
-        if (state.peek() == '"' && 
-            state.peekNext() == '"' && 
-            state.peekNext(2) == '"') {
-            state.advance();
-            state.advance();
-            state.advance();
-            return Token(TokenType::STRING, value, start_pos);
+    LiteralBuffer value(state);
+    while (true) {
+        // Everything up to the next quote, backslash or newline is plain
+        state.skipRun(CharScan::findStringSpecial);
+        if (state.isAtEnd()) {
+            break;
         }
 
-        if (state.peek() == '\\') {
-            state.advance();
-            if (state.isAtEnd()) {
-                ErrorHandler::reportError("Unterminated multiline string", start_pos);
-            }
-            char escape_char = state.peek();
-            switch (escape_char) {
-                case 'n': value += '\n'; break;
-                case 't': value += '\t'; break;
-                case 'r': value += '\r'; break;
-                case '\\': value += '\\'; break;
-                case '"': value += '"'; break;
-                case '0': case '1': case '2': case '3':
-                case '4': case '5': case '6': case '7': {
-                    int octal_value = 0;
-                    int digit_count = 0;
-
-                    while (digit_count < 3 && !state.isAtEnd() && 
-                           state.peek() >= '0' && state.peek() <= '7') {
-                        octal_value = octal_value * 8 + (state.peek() - '0');
-                        state.advance();
-                        digit_count++;
-                    }
-                    
-                    if (octal_value > 255) {
-                        ErrorHandler::reportError("Octal escape sequence out of range", state.getCurrentPosition());
-                    }
-                    
-                    value += static_cast<char>(octal_value);
-                    continue;
+        char c = state.peek();
+        if (c == '"') {
+            if (quotes == 1 || (state.peekNext() == '"' && state.peekNext(2) == '"')) {
+                Token token = value.finish(start);
+                for (int i = 0; i < quotes; ++i) {
+                    state.advance(); // closing quotes
                 }
-                case 'x': {
-                    state.advance(); // consume 'x'
-                    if (state.isAtEnd()) {
-                        ErrorHandler::reportError("Invalid hexadecimal escape sequence", state.getCurrentPosition());
-                    }
-                    
-                    int hex_value = 0;
-                    int digit_count = 0;
-                    
-                    while (digit_count < 2 && !state.isAtEnd()) {
-                        char hex_char = state.peek();
-                        if (hex_char >= '0' && hex_char <= '9') {
-                            hex_value = hex_value * 16 + (hex_char - '0');
-                        } else if (hex_char >= 'a' && hex_char <= 'f') {
-                            hex_value = hex_value * 16 + (hex_char - 'a' + 10);
-                        } else if (hex_char >= 'A' && hex_char <= 'F') {
-                            hex_value = hex_value * 16 + (hex_char - 'A' + 10);
-                        } else {
-                            break;
-                        }
-                        state.advance();
-                        digit_count++;
-                    }
-                    
-                    if (digit_count == 0) {
-                        ErrorHandler::reportError("Invalid hexadecimal escape sequence", state.getCurrentPosition());
-                    }
-                    
-                    value += static_cast<char>(hex_value);
-                    continue;
-                }
-                default:
-                    ErrorHandler::reportError("Invalid escape sequence", state.getCurrentPosition());
+                return token;
+            }
+            state.advance(); // a lone quote inside a multiline string
+        } else if (c == '\n') {
+            if (quotes == 1) {
+                state.error("Unterminated string", start_pos);
+                return value.finish(start);
             }
+            state.advance();
         } else {
-            value += state.peek();
+            value.beginEscape();
+            state.advance();
+            if (state.isAtEnd()) {
+                value.endEscape(); // a trailing backslash is dropped
+                break;
+            }
+            decodeEscape(state, value);
+            value.endEscape();
         }
-        state.advance();
     }
-    
-    ErrorHandler::reportError("Unterminated multiline string", start_pos);
-    return Token(TokenType::STRING, value, start_pos);
+
+    state.error(quotes == 1 ? "Unterminated string" : "Unterminated multiline string", start_pos);
+    return value.finish(start);
+}
+
+} // namespace
+
+Token parseString(LexerState& state) {
+    return decodeString(state, 1);
+}
+
+Token parseMultilineString(LexerState& state) {
+    return decodeString(state, 3);
 }
 
-} // namespace Lizard
\ No newline at end of file
+} // namespace Lizard
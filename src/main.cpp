@@ -1,72 +1,375 @@
 #include "lexer.h"
 #include "parser.h"
+#include "resolver.h"
+#include "analyzer.h"
 #include "evaluator.h"
+#include "compiler.h"
+#include "ir.h"
+#include "ir_passes.h"
+#include "ir_codegen.h"
+#include "vm.h"
+#include "cpp_emitter.h"
+#include "native_build.h"
+#include "script_cache.h"
+#include "snapshot.h"
+#include "source_stream.h"
 #include "error_handler.h"
+#include "diagnostics.h"
+#include "source_manager.h"
+#include "output_buffer.h"
+#include "char_scan.h"
 #include <iostream>
-#include <fstream>
 #include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace Lizard;
 
-std::string readFile(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
+// Offsets past SourceFile::MAX_SIZE would silently wrap, so such a file
+// is refused unless it is streamed
+bool checkSize(const SourceFile& file) {
+    if (file.contents().size() <= SourceFile::MAX_SIZE) {
+        return true;
+    }
+    std::cerr << "Error: '" << file.filename() << "' is larger than 4 GiB and can only be run with --stream" << std::endl;
+    return false;
+}
+
+std::shared_ptr<SourceFile> loadFile(const std::string& filename) {
+    std::shared_ptr<SourceFile> file = SourceFile::open(filename);
+    if (!file) {
         std::cerr << "Error: Could not open file '" << filename << "'" << std::endl;
         exit(1);
     }
+    if (!checkSize(*file)) {
+        exit(1);
+    }
+    return file;
+}
+
+bool hasLizardExtension(const std::string& filename) {
+    return filename.length() >= 3 && filename.substr(filename.length() - 3) == ".lz";
+}
+
+// Lexes and parses every file without running it, printing all syntax
+// errors. Returns the number of files that had errors.
+int checkFiles(const std::vector<std::string>& filenames) {
+    int failed = 0;
+    
+    for (const std::string& filename : filenames) {
+        std::shared_ptr<SourceFile> source = SourceFile::open(filename);
+        if (!source) {
+            std::cerr << "Error: Could not open file '" << filename << "'" << std::endl;
+            failed++;
+            continue;
+        }
+        if (!checkSize(*source)) {
+            failed++;
+            continue;
+        }
+        
+        uint32_t file_id = SourceManager::addFile(source);
+        Diagnostics diagnostics;
+        
+        Lexer lexer(source->contents(), file_id, diagnostics);
+        TokenList tokens = lexer.tokenize();
+        
+        Parser parser(tokens, diagnostics);
+        parser.parse();
+        
+        if (diagnostics.hasErrors()) {
+            diagnostics.print(std::cerr);
+            failed++;
+        }
+        SourceManager::releaseFile(file_id);
+    }
     
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
+    return failed;
+}
+
+bool saveSnapshot(const std::string& path, const std::vector<std::string>& slot_names,
+                  const Environment& environment) {
+    if (!Snapshot::save(path, slot_names, environment)) {
+        std::cerr << "Error: Could not write snapshot '" << path << "'" << std::endl;
+        return false;
+    }
+    return true;
 }
 
-std::vector<std::string> splitLines(const std::string& content) {
-    std::vector<std::string> lines;
-    std::stringstream ss(content);
-    std::string line;
+// Runs the script one statement at a time as it is read, so memory stays
+// bounded by the longest statement and output starts right away. Unlike a
+// normal run, the statements before a syntax error have already run when
+// it is reported, and the whole-program analysis is skipped.
+int streamFile(const std::string& filename, OutputBuffer& output) {
+    std::unique_ptr<SourceStream> stream = SourceStream::open(filename);
+    if (!stream) {
+        std::cerr << "Error: Could not open file '" << filename << "'" << std::endl;
+        return 1;
+    }
     
-    while (std::getline(ss, line)) {
-        lines.push_back(line);
+    // Diagnostics quote source lines, so a regular file is also mapped;
+    // nothing of it is paged in unless an error is formatted. The line
+    // index behind the quotes is 32-bit, so huge files go unquoted.
+    struct stat info;
+    std::shared_ptr<SourceFile> source;
+    if (stat(filename.c_str(), &info) == 0 && S_ISREG(info.st_mode) &&
+        static_cast<uint64_t>(info.st_size) <= SourceFile::MAX_SIZE) {
+        source = SourceFile::open(filename);
     }
+    uint32_t file_id = source ? SourceManager::addFile(source) : SourceManager::addFile(filename);
     
-    return lines;
+    Diagnostics diagnostics;
+    Lexer lexer(*stream, file_id, diagnostics);
+    Parser parser(lexer, diagnostics);
+    Resolver resolver;
+    Evaluator evaluator(output);
+    
+    while (true) {
+        NodeIndex stmt = parser.parseNext();
+        if (diagnostics.hasErrors()) {
+            output.flush();
+            diagnostics.print(std::cerr);
+            return 1;
+        }
+        if (stmt == NO_NODE) {
+            return 0;
+        }
+        
+        Program& program = parser.streamingProgram();
+        resolver.resolveNext(program, stmt);
+        evaluator.execute(program, stmt);
+        // Output is handed over as soon as the statement that printed it
+        // has run; flushing an empty buffer is free
+        output.flush();
+    }
+}
+
+enum class Engine {
+    VM,
+    TREE
+};
+
+// Compiles through the optimizing IR pipeline above -O0. A program that
+// keeps too many values live for the register file falls back to the
+// direct compiler.
+Chunk compileProgram(Program& program, int opt_level) {
+    if (opt_level > 0) {
+        IRFunction function = IRBuilder().build(program);
+        PassManager::forLevel(opt_level).run(function);
+        Chunk chunk;
+        if (IRCodegen().generate(function, chunk)) {
+            return chunk;
+        }
+    }
+    return Compiler().compile(program);
 }
 
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        std::cerr << "Usage: lizard <file.lz>" << std::endl;
+    Engine engine = Engine::VM;
+    bool check_only = false;
+    bool unbuffered = false;
+    bool profile = false;
+    bool dump_ir = false;
+    bool use_jit = false;
+    bool emit_cpp = false;
+    bool use_cache = true;
+    bool stream = false;
+    bool build = argc > 1 && std::string(argv[1]) == "build";
+    std::string output_path;
+    std::string snapshot_in;
+    std::string snapshot_out;
+    int opt_level = 0;
+    std::vector<std::string> filenames;
+
+    for (int i = build ? 2 : 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (build && arg == "-o" && i + 1 < argc) {
+            output_path = argv[++i];
+        } else if (arg == "--engine=vm") {
+            engine = Engine::VM;
+        } else if (arg == "--engine=tree") {
+            engine = Engine::TREE;
+        } else if (arg == "--check") {
+            check_only = true;
+        } else if (arg == "--unbuffered") {
+            unbuffered = true;
+        } else if (arg == "--profile") {
+            profile = true;
+        } else if (arg == "--jit") {
+            use_jit = true;
+        } else if (arg == "--dump-ir") {
+            dump_ir = true;
+        } else if (arg == "--emit-cpp") {
+            emit_cpp = true;
+        } else if (arg == "--stream") {
+            stream = true;
+        } else if (arg == "--no-cache") {
+            use_cache = false;
+        } else if (arg == "--snapshot-in" && i + 1 < argc) {
+            snapshot_in = argv[++i];
+        } else if (arg == "--snapshot-out" && i + 1 < argc) {
+            snapshot_out = argv[++i];
+        } else if (arg == "-O0" || arg == "-O1" || arg == "-O2") {
+            opt_level = arg[2] - '0';
+        } else if (arg.rfind("--", 0) == 0) {
+            std::cerr << "Error: Unknown option '" << arg << "'" << std::endl;
+            return 1;
+        } else {
+            filenames.push_back(arg);
+        }
+    }
+
+    if (filenames.empty() || (!check_only && filenames.size() != 1)) {
+        std::cerr << "Usage: lizard [--engine=vm|tree] [-O0|-O1|-O2] [--jit] [--unbuffered] [--profile] [--no-cache] <file.lz>" << std::endl;
+        std::cerr << "       lizard --stream [--unbuffered] <file.lz>" << std::endl;
+        std::cerr << "       lizard [--snapshot-in <image>] [--snapshot-out <image>] <file.lz>" << std::endl;
+        std::cerr << "       lizard [-O0|-O1|-O2] --dump-ir <file.lz>" << std::endl;
+        std::cerr << "       lizard --emit-cpp <file.lz>" << std::endl;
+        std::cerr << "       lizard build [-o <executable>] <file.lz>" << std::endl;
+        std::cerr << "       lizard --check <file.lz>..." << std::endl;
         return 1;
     }
-    
-    std::string filename = argv[1];
 
-    if (filename.length() < 3 || filename.substr(filename.length() - 3) != ".lz") {
-        std::cerr << "Error: Lizard files must have .lz extension" << std::endl;
+    for (const std::string& name : filenames) {
+        if (!hasLizardExtension(name)) {
+            std::cerr << "Error: Lizard files must have .lz extension" << std::endl;
+            return 1;
+        }
+    }
+    
+    if (check_only) {
+        return checkFiles(filenames) == 0 ? 0 : 1;
+    }
+    
+    if (stream && (dump_ir || emit_cpp || build || profile ||
+                   !snapshot_in.empty() || !snapshot_out.empty())) {
+        std::cerr << "Error: --stream only runs the script and cannot be combined with other modes" << std::endl;
         return 1;
     }
     
+    // Generated programs have no way to start from a snapshot
+    if (!snapshot_in.empty() && (emit_cpp || build)) {
+        std::cerr << "Error: --snapshot-in cannot be combined with --emit-cpp or build" << std::endl;
+        return 1;
+    }
+    
+    std::unique_ptr<Snapshot> snapshot;
+    if (!snapshot_in.empty()) {
+        snapshot = Snapshot::load(snapshot_in);
+        if (!snapshot) {
+            std::cerr << "Error: Could not load snapshot '" << snapshot_in << "'" << std::endl;
+            return 1;
+        }
+        // Slots depend on the snapshot, which the cache does not record
+        use_cache = false;
+    }
+    
+    const std::string& filename = filenames.front();
+    OutputBuffer output(STDOUT_FILENO);
+    output.setLineBuffered(unbuffered);
+    
     try {
-        std::string source = readFile(filename);
-        std::vector<std::string> source_lines = splitLines(source);
+        if (stream) {
+            return streamFile(filename, output);
+        }
         
-        ErrorHandler::setSourceFile(filename, source_lines);
+        std::shared_ptr<SourceFile> source = loadFile(filename);
+        uint32_t file_id = SourceManager::addFile(source);
         
-        Lexer lexer(source, filename);
-        std::vector<Token> tokens = lexer.tokenize();
+        std::unique_ptr<Program> program;
+        if (use_cache) {
+            program = ScriptCache::load(*source, file_id);
+        }
+        
+        if (!program) {
+            Diagnostics diagnostics;
+            
+            Lexer lexer(source->contents(), file_id, diagnostics);
+            TokenList tokens = lexer.tokenize();
+
+            Parser parser(tokens, diagnostics);
+            program = parser.parse();
+            
+            if (diagnostics.hasErrors()) {
+                diagnostics.print(std::cerr);
+                return 1;
+            }
+
+            Resolver resolver;
+            resolver.resolve(*program, snapshot ? &snapshot->names : nullptr);
+            
+            StaticAnalyzer analyzer;
+            analyzer.analyze(*program, snapshot ? &snapshot->variables : nullptr);
+            
+            if (use_cache) {
+                ScriptCache::store(*program, *source);
+            }
+        }
+
+        if (dump_ir) {
+            IRFunction function = IRBuilder().build(*program);
+            PassManager::forLevel(opt_level).run(function, &std::cout);
+            return 0;
+        }
+
+        if (emit_cpp) {
+            CppEmitter().emit(*program, *source, std::cout);
+            return 0;
+        }
+
+        if (build) {
+            std::ostringstream cpp;
+            CppEmitter().emit(*program, *source, cpp);
+            if (output_path.empty()) {
+                output_path = filename.substr(0, filename.length() - 3);
+            }
+            return NativeBuild::build(cpp.str(), output_path) ? 0 : 1;
+        }
 
-        Parser parser(tokens);
-        auto program = parser.parse();
+        if (engine == Engine::VM) {
+            Chunk chunk = compileProgram(*program, opt_level);
 
-        Evaluator evaluator;
-        evaluator.evaluate(*program);
+            VirtualMachine vm(output);
+            vm.setJitEnabled(use_jit);
+            if (snapshot) {
+                vm.setPrelude(snapshot->variables);
+            }
+            vm.run(chunk);
+            if (profile) {
+                output.flush();
+                vm.printProfile(std::cerr);
+                std::cerr << "Lexer scan kernels: " << CharScan::implementation() << "\n";
+            }
+            if (!snapshot_out.empty() && !saveSnapshot(snapshot_out, chunk.names, vm.globals())) {
+                return 1;
+            }
+        } else {
+            Evaluator evaluator(output);
+            if (snapshot) {
+                evaluator.setPrelude(snapshot->variables);
+            }
+            evaluator.evaluate(*program);
+            if (profile) {
+                output.flush();
+                evaluator.printProfile(std::cerr);
+                std::cerr << "Lexer scan kernels: " << CharScan::implementation() << "\n";
+            }
+            if (!snapshot_out.empty() && !saveSnapshot(snapshot_out, program->slot_names, evaluator.globals())) {
+                return 1;
+            }
+        }
         
     } catch (const LizardError& e) {
+        // Output produced before the error must appear before it
+        output.flush();
         std::cerr << e.formatError() << std::endl;
         return 1;
     } catch (const std::exception& e) {
+        output.flush();
         std::cerr << "Internal error: " << e.what() << std::endl;
         return 1;
     }
     
+    output.flush();
     return 0;
 }
\ No newline at end of file
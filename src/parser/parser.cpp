@@ -1,47 +1,129 @@
 #include "parser.h"
 #include "error_handler.h"
+#include <algorithm>
 
 namespace Lizard {
 
-Parser::Parser(const std::vector<Token>& tokens) 
-    : tokens(tokens), current(0), arithmetic_parser(this) {}
+Parser::Parser(const TokenList& tokens, Diagnostics& diagnostics) 
+    : token_list(tokens), tokens(tokens.tokens), diagnostics(diagnostics), current(0),
+      program(std::make_unique<Program>()), arithmetic_parser(this) {}
+
+Parser::Parser(Lexer& lexer, Diagnostics& diagnostics)
+    : token_list(stream_tokens), tokens(stream_tokens.tokens), lexer(&lexer),
+      diagnostics(diagnostics), current(0), program(std::make_unique<Program>()),
+      arithmetic_parser(this) {
+    stream_tokens.file = lexer.file();
+    pullToken();
+}
 
 std::unique_ptr<Program> Parser::parse() {
-    auto program = std::make_unique<Program>(Position());
+    // Rough upper bound: most tokens become at most one node
+    program->nodes.reserve(tokens.size());
+    program->positions.reserve(tokens.size());
     
-    while (!isAtEnd()) {
+    while (!isAtEnd() && !diagnostics.limitReached()) {
         // Skip newlines
         if (match(TokenType::NEWLINE)) {
             continue;
         }
         
-        try {
-            auto stmt = statement();
-            if (stmt) {
-                program->statements.push_back(std::move(stmt));
-            }
-        } catch (const LizardError&) {
+        NodeIndex first = static_cast<NodeIndex>(program->nodes.size());
+        NodeIndex stmt = statement();
+        if (stmt != NO_NODE) {
+            program->statements.push_back(stmt);
+        } else {
+            program->truncate(first);
             synchronize();
         }
     }
     
-    return program;
+    program->nodes.shrink_to_fit();
+    program->positions.shrink_to_fit();
+    return std::move(program);
+}
+
+NodeIndex Parser::parseNext() {
+    releaseStatement();
+    
+    while (match(TokenType::NEWLINE)) {}
+    if (isAtEnd() || diagnostics.limitReached()) {
+        return NO_NODE;
+    }
+    
+    NodeIndex stmt = statement();
+    if (stmt != NO_NODE) {
+        program->statements.push_back(stmt);
+    }
+    return stmt;
+}
+
+void Parser::pullToken() {
+    Token token = lexer->next();
+    // The lexer's decoded buffer is dropped whenever its source is, so
+    // decoded text moves into the parser's own list
+    if (token.flags & Token::DECODED) {
+        std::string_view text = decodedText(lexer->decoded(), token.offset);
+        token.offset = static_cast<uint32_t>(stream_tokens.decoded.size());
+        stream_tokens.decoded.append(text.data() - sizeof(uint32_t), sizeof(uint32_t) + text.size());
+    }
+    stream_tokens.tokens.push_back(token);
+    stream_tokens.source = lexer->source();
+}
+
+void Parser::releaseStatement() {
+    program->truncate(0);
+    program->statements.clear();
+    program->constants.clear();
+    program->binary_sites = 0;
+    
+    std::vector<Token>& list = stream_tokens.tokens;
+    list.erase(list.begin(), list.begin() + current);
+    current = 0;
+    
+    // Source text is only dropped once a chunk's worth of it is behind
+    // every token still held, so each byte is moved a bounded number of times
+    size_t keep = lexer->consumed();
+    bool uses_decoded = false;
+    for (const Token& token : list) {
+        if (token.flags & Token::DECODED) {
+            uses_decoded = true;
+        } else {
+            keep = std::min<size_t>(keep, token.offset);
+        }
+    }
+    if (!uses_decoded) {
+        stream_tokens.decoded.clear();
+    }
+    if (keep >= SourceStream::CHUNK_SIZE) {
+        lexer->discard(keep);
+        for (Token& token : list) {
+            if (!(token.flags & Token::DECODED)) {
+                token.offset -= static_cast<uint32_t>(keep);
+            }
+        }
+        stream_tokens.source = lexer->source();
+    }
 }
 
 bool Parser::isAtEnd() const {
     return peek().type == TokenType::EOF_TOKEN;
 }
 
-Token Parser::peek() const {
+const Token& Parser::peek() const {
     return tokens[current];
 }
 
-Token Parser::previous() const {
+const Token& Parser::previous() const {
     return tokens[current - 1];
 }
 
-Token Parser::advance() {
-    if (!isAtEnd()) current++;
+const Token& Parser::advance() {
+    if (!isAtEnd()) {
+        current++;
+        if (lexer && current == tokens.size()) {
+            pullToken();
+        }
+    }
     return previous();
 }
 
@@ -58,13 +140,30 @@ bool Parser::match(TokenType type) {
     return false;
 }
 
-void Parser::consume(TokenType type, const std::string& message) {
+bool Parser::consume(TokenType type, const std::string& message) {
     if (check(type)) {
         advance();
-        return;
+        return true;
+    }
+    
+    error(message, position(peek()));
+    return false;
+}
+
+uint32_t Parser::internName(std::string_view name) {
+    auto it = name_ids.find(name);
+    if (it != name_ids.end()) {
+        return it->second;
     }
     
-    ErrorHandler::reportError(message, peek().position);
+    uint32_t id = static_cast<uint32_t>(program->names.size());
+    program->names.emplace_back(name);
+    if (lexer) {
+        // Streaming drops the source text the view points into
+        name = owned_names.emplace_back(name);
+    }
+    name_ids.emplace(name, id);
+    return id;
 }
 
 void Parser::synchronize() {
@@ -86,7 +185,7 @@ void Parser::synchronize() {
     }
 }
 
-ASTNodePtr Parser::statement() {
+NodeIndex Parser::statement() {
     if (match(TokenType::VAR) || match(TokenType::FIX)) {
         return variableDeclaration();
     }
@@ -106,55 +205,65 @@ ASTNodePtr Parser::statement() {
         current = saved_current; // restore position
     }
     
-    ErrorHandler::reportError("Expected statement", peek().position);
-    return nullptr;
+    error("Expected statement", position(peek()));
+    return NO_NODE;
 }
 
-ASTNodePtr Parser::variableDeclaration() {
+NodeIndex Parser::variableDeclaration() {
     bool is_constant = previous().type == TokenType::FIX;
-    Position decl_pos = previous().position;
+    Position decl_pos = position(previous());
     
     if (!check(TokenType::IDENTIFIER)) {
-        ErrorHandler::reportError("Expected variable name", peek().position);
+        error("Expected variable name", position(peek()));
+        return NO_NODE;
     }
     
     Token name_token = advance();
     
-    ASTNodePtr value = nullptr;
+    NodeIndex value = NO_NODE;
     if (match(TokenType::ASSIGN)) {
         value = expression();
+        if (value == NO_NODE) {
+            return NO_NODE;
+        }
     }
     
-    return std::make_unique<VariableDeclaration>(
-        name_token.value, std::move(value), is_constant, decl_pos, name_token.position
-    );
+    NodeIndex target = emit(ASTNode::identifier(internName(text(name_token))), position(name_token));
+    return emit(ASTNode::declaration(target, value, is_constant), decl_pos);
 }
 
-ASTNodePtr Parser::variableAssignment() {
+NodeIndex Parser::variableAssignment() {
     Token name_token = advance();
-    Position assign_pos = peek().position;
+    Position assign_pos = position(peek());
     
-    consume(TokenType::ASSIGN, "Expected '=' after variable name");
+    if (!consume(TokenType::ASSIGN, "Expected '=' after variable name")) {
+        return NO_NODE;
+    }
     
-    auto value = expression();
+    NodeIndex value = expression();
+    if (value == NO_NODE) {
+        return NO_NODE;
+    }
     
-    return std::make_unique<VariableAssignment>(
-        name_token.value, std::move(value), assign_pos, name_token.position
-    );
+    NodeIndex target = emit(ASTNode::identifier(internName(text(name_token))), position(name_token));
+    return emit(ASTNode::assignment(target, value), assign_pos);
 }
 
-ASTNodePtr Parser::printStatement() {
-    Position print_pos = previous().position;
-    auto expr = expression();
+NodeIndex Parser::printStatement() {
+    Position print_pos = position(previous());
+    NodeIndex expr = expression();
+    if (expr == NO_NODE) {
+        return NO_NODE;
+    }
     
-    return std::make_unique<PrintStatement>(std::move(expr), print_pos);
+    return emit(ASTNode::print(expr), print_pos);
 }
 
-ASTNodePtr Parser::expression() {
+NodeIndex Parser::expression() {
     return arithmetic_parser.parseExpression();
 }
 
-ASTNodePtr Parser::primary() {
+NodeIndex Parser::primary() {
     return arithmetic_parser.parsePrimary();
 }
 
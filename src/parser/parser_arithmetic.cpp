@@ -1,56 +1,75 @@
 #include "parser_arithmetic.h"
 #include "parser.h"
+#include "parser_fold.h"
 #include "error_handler.h"
+#include "number_format.h"
 
 namespace Lizard {
 
-ASTNodePtr ArithmeticParser::parseExpression() {
+ArithmeticParser::ArithmeticParser(Parser* p) : parser(p), folder(*p->program) {}
+
+NodeIndex ArithmeticParser::parseExpression() {
     return parseAddition();
 }
 
-ASTNodePtr ArithmeticParser::parseAddition() {
-    auto expr = parseMultiplication();
+NodeIndex ArithmeticParser::parseAddition() {
+    NodeIndex expr = parseMultiplication();
+    if (expr == NO_NODE) {
+        return NO_NODE;
+    }
     
     while (parser->check(TokenType::PLUS) || parser->check(TokenType::MINUS)) {
         Token op_token = parser->advance();
-        Position op_pos = op_token.position;
-        auto right = parseMultiplication();
+        Position op_pos = parser->position(op_token);
+        NodeIndex right = parseMultiplication();
+        if (right == NO_NODE) {
+            return NO_NODE;
+        }
         
         BinaryOperator op = tokenToBinaryOperator(op_token.type);
-        expr = std::make_unique<BinaryExpression>(std::move(expr), op, std::move(right), op_pos);
+        expr = folder.foldBinary(expr, op, right, op_pos);
     }
     
     return expr;
 }
 
-ASTNodePtr ArithmeticParser::parseMultiplication() {
-    auto expr = parseUnary();
+NodeIndex ArithmeticParser::parseMultiplication() {
+    NodeIndex expr = parseUnary();
+    if (expr == NO_NODE) {
+        return NO_NODE;
+    }
     
     while (parser->check(TokenType::STARS) || parser->check(TokenType::SLASH) || 
            parser->check(TokenType::INT_DIVISION) || parser->check(TokenType::PERCENT)) {
         Token op_token = parser->advance();
-        Position op_pos = op_token.position;
-        auto right = parseUnary();
+        Position op_pos = parser->position(op_token);
+        NodeIndex right = parseUnary();
+        if (right == NO_NODE) {
+            return NO_NODE;
+        }
         
         BinaryOperator op = tokenToBinaryOperator(op_token.type);
-        expr = std::make_unique<BinaryExpression>(std::move(expr), op, std::move(right), op_pos);
+        expr = folder.foldBinary(expr, op, right, op_pos);
     }
     
     return expr;
 }
 
-ASTNodePtr ArithmeticParser::parseUnary() {
+NodeIndex ArithmeticParser::parseUnary() {
     if (parser->match(TokenType::MINUS) || parser->match(TokenType::PLUS)) {
         Token op_token = parser->previous();
-        Position op_pos = op_token.position;
-        auto expr = parseUnary();
+        Position op_pos = parser->position(op_token);
+        NodeIndex expr = parseUnary();
+        if (expr == NO_NODE) {
+            return NO_NODE;
+        }
         
-        // For unary minus, create a binary expression: 0 - expr
+        // For unary minus, create a binary expression: 0 - expr, which folds
+        // straight to a Literal when expr is one
         // For unary plus, just return the expression as-is
         if (op_token.type == TokenType::MINUS) {
-            auto zero = std::make_unique<Literal>(Token(TokenType::INTEGER, "0", op_pos));
-            BinaryOperator op = BinaryOperator::SUBTRACT;
-            return std::make_unique<BinaryExpression>(std::move(zero), op, std::move(expr), op_pos);
+            NodeIndex zero = parser->emit(ASTNode::literal(parser->program->constants.add(Value(0))), op_pos);
+            return folder.foldBinary(zero, BinaryOperator::SUBTRACT, expr, op_pos);
         } else {
             return expr; // Unary plus does nothing
         }
@@ -59,32 +78,67 @@ ASTNodePtr ArithmeticParser::parseUnary() {
     return parsePrimary();
 }
 
-ASTNodePtr ArithmeticParser::parsePrimary() {
+NodeIndex ArithmeticParser::parsePrimary() {
     if (parser->match(TokenType::STRING) || parser->match(TokenType::INTEGER) || 
         parser->match(TokenType::FLOAT) || parser->match(TokenType::BOOLEAN) || 
         parser->match(TokenType::NIL)) {
-        return std::make_unique<Literal>(parser->previous());
+        const Token& token = parser->previous();
+        return parser->emit(ASTNode::literal(parser->program->constants.add(decodeLiteral(token))),
+                            parser->position(token));
     }
     
     if (parser->match(TokenType::IDENTIFIER)) {
-        return std::make_unique<Identifier>(parser->previous().value, parser->previous().position);
+        const Token& token = parser->previous();
+        return parser->emit(ASTNode::identifier(parser->internName(parser->text(token))),
+                            parser->position(token));
     }
     
     // Handle parentheses for grouping
     if (parser->match(TokenType::LEFT_PAREN)) {
-        Position paren_pos = parser->previous().position;
-        auto expr = parseExpression();
+        NodeIndex expr = parseExpression();
+        if (expr == NO_NODE) {
+            return NO_NODE;
+        }
         
         if (!parser->match(TokenType::RIGHT_PAREN)) {
-            ErrorHandler::reportError("Expected ')' after expression", parser->peek().position);
-            return nullptr;
+            parser->error("Expected ')' after expression", parser->position(parser->peek()));
+            return NO_NODE;
         }
         
         return expr; // Return the grouped expression
     }
     
-    ErrorHandler::reportError("Expected expression", parser->peek().position);
-    return nullptr;
+    parser->error("Expected expression", parser->position(parser->peek()));
+    return NO_NODE;
+}
+
+Value ArithmeticParser::decodeLiteral(const Token& token) {
+    std::string_view text = parser->text(token);
+    
+    switch (token.type) {
+        case TokenType::STRING:
+            return Value(std::string(text));
+        case TokenType::INTEGER: {
+            int64_t result = 0;
+            if (NumberFormat::parseInt(text, result) == NumberFormat::ParseStatus::OUT_OF_RANGE) {
+                return Value(BigInt::parse(text));
+            }
+            return Value(result);
+        }
+        case TokenType::FLOAT: {
+            double result = 0.0;
+            if (NumberFormat::parseFloat(text, result) != NumberFormat::ParseStatus::OK) {
+                parser->error("Float literal '" + std::string(text) + "' is out of range", parser->position(token));
+            }
+            return Value(result);
+        }
+        case TokenType::BOOLEAN:
+            return Value(text == "true");
+        case TokenType::NIL:
+            return Value(nullptr);
+        default:
+            ErrorHandler::reportError("Unknown literal type", parser->position(token));
+    }
 }
 
 BinaryOperator ArithmeticParser::tokenToBinaryOperator(TokenType type) {
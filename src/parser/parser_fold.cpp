@@ -0,0 +1,124 @@
+#include "parser_fold.h"
+#include "eval_arithmetic.h"
+#include <algorithm>
+
+namespace Lizard {
+
+const Value* ConstantFolder::constantValue(NodeIndex node) const {
+    if (program[node].type != ASTNodeType::LITERAL) {
+        return nullptr;
+    }
+    return &program.constants[program[node].constant()];
+}
+
+bool ConstantFolder::isIntegerConstant(NodeIndex node, int expected) const {
+    const Value* value = constantValue(node);
+    return value && value->isSmallInteger() && value->get<int64_t>() == expected;
+}
+
+bool ConstantFolder::isNumber(StaticType type) {
+    return type == StaticType::NUMBER || type == StaticType::INTEGER || type == StaticType::FLOAT;
+}
+
+// Type of the value an expression produces when it does not raise an error
+ConstantFolder::StaticType ConstantFolder::staticTypeOf(NodeIndex index) const {
+    if (const Value* value = constantValue(index)) {
+        switch (value->getType()) {
+            case ValueType::INTEGER: return StaticType::INTEGER;
+            case ValueType::FLOAT:   return StaticType::FLOAT;
+            default:                 return StaticType::OTHER;
+        }
+    }
+    
+    const ASTNode& node = program[index];
+    if (node.type != ASTNodeType::BINARY_EXPRESSION) {
+        return StaticType::UNKNOWN;
+    }
+    
+    switch (node.op) {
+        case BinaryOperator::DIVIDE:
+            return StaticType::FLOAT;
+        case BinaryOperator::INT_DIV:
+        case BinaryOperator::MODULO:
+            return StaticType::INTEGER;
+        case BinaryOperator::ADD:
+        case BinaryOperator::SUBTRACT:
+        case BinaryOperator::MULTIPLY: {
+            StaticType left = staticTypeOf(node.left());
+            StaticType right = staticTypeOf(node.right());
+            if (left == StaticType::INTEGER && right == StaticType::INTEGER) {
+                return StaticType::INTEGER;
+            }
+            if ((left == StaticType::FLOAT && isNumber(right)) ||
+                (right == StaticType::FLOAT && isNumber(left))) {
+                return StaticType::FLOAT;
+            }
+            // '+' concatenates when either side is a string
+            return node.op == BinaryOperator::ADD ? StaticType::UNKNOWN : StaticType::NUMBER;
+        }
+    }
+    return StaticType::UNKNOWN;
+}
+
+NodeIndex ConstantFolder::foldBinary(NodeIndex left, BinaryOperator op, NodeIndex right,
+                                     const Position& pos) {
+    const Value* left_value = constantValue(left);
+    const Value* right_value = constantValue(right);
+    if (left_value && right_value &&
+        ArithmeticEvaluator::canEvaluate(op, *left_value, *right_value)) {
+        Value result = ArithmeticEvaluator::evaluate(op, *left_value, *right_value, pos);
+        // Both operands are single nodes at the tail; replace them
+        program.truncate(std::min(left, right));
+        return program.add(ASTNode::literal(program.constants.add(result)), pos);
+    }
+    
+    // Identities are only applied where the result is bit-for-bit the operand,
+    // e.g. `x + 0` is skipped for floats (-0.0 + 0 is 0.0) and strings ("a0").
+    // A dropped literal on the left stays behind as an unreferenced node.
+    NodeIndex result = NO_NODE;
+    switch (op) {
+        case BinaryOperator::ADD:
+            if (isIntegerConstant(right, 0) && staticTypeOf(left) == StaticType::INTEGER) {
+                result = left;
+            } else if (isIntegerConstant(left, 0) && staticTypeOf(right) == StaticType::INTEGER) {
+                result = right;
+            }
+            break;
+        case BinaryOperator::SUBTRACT:
+            if (isIntegerConstant(right, 0) && isNumber(staticTypeOf(left))) {
+                result = left;
+            }
+            break;
+        case BinaryOperator::MULTIPLY:
+            if (isIntegerConstant(right, 1) && isNumber(staticTypeOf(left))) {
+                result = left;
+            } else if (isIntegerConstant(left, 1) && isNumber(staticTypeOf(right))) {
+                result = right;
+            }
+            break;
+        case BinaryOperator::DIVIDE:
+            if (isIntegerConstant(right, 1) && staticTypeOf(left) == StaticType::FLOAT) {
+                result = left;
+            }
+            break;
+        case BinaryOperator::INT_DIV:
+            if (isIntegerConstant(right, 1) && staticTypeOf(left) == StaticType::INTEGER) {
+                result = left;
+            }
+            break;
+        case BinaryOperator::MODULO:
+            break;
+    }
+    
+    if (result != NO_NODE) {
+        NodeIndex dropped = result == left ? right : left;
+        if (isLastNode(dropped)) {
+            program.truncate(dropped);
+        }
+        return result;
+    }
+    
+    return program.add(ASTNode::binary(op, left, right, program.binary_sites++), pos);
+}
+
+} // namespace Lizard
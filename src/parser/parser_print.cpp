@@ -6,8 +6,8 @@ namespace Lizard {
 // Additional print statement parsing utilities
 namespace PrintParser {
 
-void validatePrintExpression(const ASTNode* expr, const Position& pos) {
-    if (!expr) {
+void validatePrintExpression(NodeIndex expr, const Position& pos) {
+    if (expr == NO_NODE) {
         ErrorHandler::reportError("Expected expression after 'put'", pos);
     }
     
@@ -0,0 +1,83 @@
+#include "resolver.h"
+#include "error_handler.h"
+#include <string_view>
+#include <unordered_map>
+
+namespace Lizard {
+
+void Resolver::resolve(Program& program, const std::vector<std::string>* predefined) {
+    this->program = &program;
+    slots.assign(program.names.size(), NO_SLOT);
+    program.slot_names.clear();
+
+    if (predefined) {
+        std::unordered_map<std::string_view, uint32_t> name_indices;
+        for (uint32_t i = 0; i < program.names.size(); ++i) {
+            name_indices.emplace(program.names[i], i);
+        }
+        for (const std::string& name : *predefined) {
+            auto found = name_indices.find(name);
+            if (found != name_indices.end()) {
+                slots[found->second] = static_cast<uint32_t>(program.slot_names.size());
+            }
+            program.slot_names.push_back(name);
+        }
+    }
+
+    for (NodeIndex stmt : program.statements) {
+        resolveStatement(stmt);
+    }
+}
+
+void Resolver::resolveNext(Program& program, NodeIndex statement) {
+    this->program = &program;
+    slots.resize(program.names.size(), NO_SLOT);
+    resolveStatement(statement);
+}
+
+void Resolver::resolveStatement(NodeIndex index) {
+    const ASTNode& node = (*program)[index];
+    switch (node.type) {
+        case ASTNodeType::VARIABLE_DECLARATION:
+        case ASTNodeType::VARIABLE_ASSIGNMENT:
+            if (node.value() != NO_NODE) {
+                resolveExpression(node.value());
+            }
+            bindIdentifier(node.target());
+            break;
+        case ASTNodeType::PRINT_STATEMENT:
+            resolveExpression(node.expression());
+            break;
+        default:
+            ErrorHandler::reportError("Unknown statement type", program->position(index));
+    }
+}
+
+void Resolver::resolveExpression(NodeIndex index) {
+    const ASTNode& node = (*program)[index];
+    switch (node.type) {
+        case ASTNodeType::LITERAL:
+            break;
+        case ASTNodeType::IDENTIFIER:
+            bindIdentifier(index);
+            break;
+        case ASTNodeType::BINARY_EXPRESSION:
+            resolveExpression(node.left());
+            resolveExpression(node.right());
+            break;
+        default:
+            ErrorHandler::reportError("Unknown expression type", program->position(index));
+    }
+}
+
+void Resolver::bindIdentifier(NodeIndex index) {
+    ASTNode& node = (*program)[index];
+    uint32_t& slot = slots[node.name()];
+    if (slot == NO_SLOT) {
+        slot = static_cast<uint32_t>(program->slot_names.size());
+        program->slot_names.push_back(program->names[node.name()]);
+    }
+    node.b = slot;
+}
+
+} // namespace Lizard
@@ -0,0 +1,51 @@
+#include "aot_runtime.h"
+#include "error_handler.h"
+#include "source_file.h"
+#include "source_manager.h"
+#include <iostream>
+#include <unistd.h>
+
+namespace Lizard {
+
+CompiledProgram::CompiledProgram(const std::string& filename, std::string_view source,
+                                 const std::vector<std::string>& slot_names)
+    : slot_names(slot_names),
+      file_id(SourceManager::addFile(SourceFile::fromString(filename, std::string(source)))),
+      output(STDOUT_FILENO) {
+    environment.reset(this->slot_names);
+}
+
+int CompiledProgram::run(int argc, char* argv[], const Part* parts, size_t count) {
+    bool unbuffered = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--unbuffered") {
+            unbuffered = true;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--unbuffered]" << std::endl;
+            return 1;
+        }
+    }
+
+    output.setLineBuffered(unbuffered);
+
+    try {
+        for (size_t i = 0; i < count; ++i) {
+            parts[i](*this);
+        }
+    } catch (const LizardError& e) {
+        // Output produced before the error must appear before it
+        output.flush();
+        std::cerr << e.formatError() << std::endl;
+        return 1;
+    } catch (const std::exception& e) {
+        output.flush();
+        std::cerr << "Internal error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    output.flush();
+    return 0;
+}
+
+} // namespace Lizard
@@ -0,0 +1,97 @@
+#include "source_file.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Lizard {
+
+std::shared_ptr<SourceFile> SourceFile::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+    
+    std::shared_ptr<SourceFile> file(new SourceFile());
+    file->name = path;
+    
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void* mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            file->mapping = mapping;
+            file->data = static_cast<const char*>(mapping);
+            file->size = static_cast<size_t>(info.st_size);
+            close(fd);
+            return file;
+        }
+    }
+    
+    // Pipes, character devices and anything else that cannot be mapped
+    char chunk[65536];
+    while (true) {
+        ssize_t n = read(fd, chunk, sizeof(chunk));
+        if (n == 0) {
+            break;
+        }
+        if (n < 0) {
+            close(fd);
+            return nullptr;
+        }
+        file->buffer.append(chunk, static_cast<size_t>(n));
+    }
+    close(fd);
+    
+    file->data = file->buffer.data();
+    file->size = file->buffer.size();
+    return file;
+}
+
+std::shared_ptr<SourceFile> SourceFile::fromString(const std::string& name, std::string text) {
+    std::shared_ptr<SourceFile> file(new SourceFile());
+    file->name = name;
+    file->buffer = std::move(text);
+    file->data = file->buffer.data();
+    file->size = file->buffer.size();
+    return file;
+}
+
+SourceFile::~SourceFile() {
+    if (mapping) {
+        munmap(mapping, size);
+    }
+}
+
+void SourceFile::buildLineIndex() const {
+    line_starts.push_back(0);
+    for (size_t i = 0; i < size; ++i) {
+        if (data[i] == '\n' && i + 1 < size) {
+            line_starts.push_back(static_cast<uint32_t>(i + 1));
+        }
+    }
+}
+
+size_t SourceFile::lineCount() const {
+    if (size == 0) {
+        return 0;
+    }
+    if (line_starts.empty()) {
+        buildLineIndex();
+    }
+    return line_starts.size();
+}
+
+std::string_view SourceFile::line(int line_number) const {
+    if (line_number < 1 || static_cast<size_t>(line_number) > lineCount()) {
+        return std::string_view();
+    }
+    
+    size_t start = line_starts[line_number - 1];
+    size_t end = start;
+    while (end < size && data[end] != '\n') {
+        end++;
+    }
+    return std::string_view(data + start, end - start);
+}
+
+} // namespace Lizard
@@ -0,0 +1,82 @@
+#include "source_manager.h"
+#include "token.h"
+#include <deque>
+#include <sys/stat.h>
+
+namespace Lizard {
+
+namespace {
+
+struct FileEntry {
+    std::string filename;
+    std::shared_ptr<const SourceFile> file;
+};
+
+std::deque<FileEntry>& entries() {
+    static std::deque<FileEntry> files{FileEntry{"", nullptr}};
+    return files;
+}
+
+} // namespace
+
+uint32_t SourceManager::addFile(std::shared_ptr<const SourceFile> file) {
+    std::string name = file->filename();
+    entries().push_back(FileEntry{std::move(name), std::move(file)});
+    return static_cast<uint32_t>(entries().size() - 1);
+}
+
+uint32_t SourceManager::addFile(const std::string& filename) {
+    entries().push_back(FileEntry{filename, nullptr});
+    return static_cast<uint32_t>(entries().size() - 1);
+}
+
+const std::string& SourceManager::filename(uint32_t file_id) {
+    if (file_id >= entries().size()) {
+        return entries().front().filename;
+    }
+    return entries()[file_id].filename;
+}
+
+const SourceFile* SourceManager::file(uint32_t file_id) {
+    if (file_id >= entries().size()) {
+        return nullptr;
+    }
+    return entries()[file_id].file.get();
+}
+
+std::shared_ptr<const SourceFile> SourceManager::sharedFile(uint32_t file_id) {
+    if (file_id >= entries().size()) {
+        return nullptr;
+    }
+    return entries()[file_id].file;
+}
+
+const SourceFile* SourceManager::loadFile(uint32_t file_id) {
+    if (file_id == 0 || file_id >= entries().size()) {
+        return nullptr;
+    }
+    FileEntry& entry = entries()[file_id];
+    if (!entry.file) {
+        // Anything but a regular file (a pipe, say) could block or be
+        // consumed by reading it again
+        struct stat info;
+        if (stat(entry.filename.c_str(), &info) != 0 || !S_ISREG(info.st_mode) ||
+            static_cast<uint64_t>(info.st_size) > SourceFile::MAX_SIZE) {
+            return nullptr;
+        }
+        entry.file = SourceFile::open(entry.filename);
+    }
+    return entry.file.get();
+}
+
+void SourceManager::releaseFile(uint32_t file_id) {
+    if (file_id < entries().size()) {
+        entries()[file_id].file.reset();
+    }
+}
+
+const std::string& Position::filename() const {
+    return SourceManager::filename(file);
+}
+
+} // namespace Lizard
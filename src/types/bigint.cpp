@@ -0,0 +1,354 @@
+#include "bigint.h"
+#include "number_format.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Lizard {
+
+namespace {
+
+constexpr uint64_t LIMB_BASE = uint64_t(1) << 32;
+// Largest power of ten that fits in a limb, used for decimal conversion
+constexpr uint32_t DECIMAL_CHUNK = 1000000000;
+constexpr int DECIMAL_CHUNK_DIGITS = 9;
+
+} // namespace
+
+BigInt::BigInt(int64_t value) : negative(value < 0) {
+    // Negate in unsigned arithmetic so INT64_MIN is handled
+    uint64_t magnitude = negative ? ~static_cast<uint64_t>(value) + 1 : static_cast<uint64_t>(value);
+    while (magnitude != 0) {
+        limbs.push_back(static_cast<uint32_t>(magnitude));
+        magnitude >>= 32;
+    }
+}
+
+BigInt::BigInt(Limbs magnitude, bool negative) : limbs(std::move(magnitude)), negative(negative) {
+    trim(limbs);
+    if (limbs.empty()) {
+        this->negative = false;
+    }
+}
+
+BigInt BigInt::parse(std::string_view digits) {
+    Limbs magnitude;
+    size_t first_chunk = digits.size() % DECIMAL_CHUNK_DIGITS;
+    if (first_chunk == 0) {
+        first_chunk = DECIMAL_CHUNK_DIGITS;
+    }
+    
+    for (size_t i = 0; i < digits.size();) {
+        size_t length = i == 0 ? first_chunk : DECIMAL_CHUNK_DIGITS;
+        uint32_t chunk = 0;
+        uint32_t scale = 1;
+        for (size_t j = 0; j < length; ++j) {
+            chunk = chunk * 10 + static_cast<uint32_t>(digits[i + j] - '0');
+            scale *= 10;
+        }
+        multiplyAddSmall(magnitude, scale, chunk);
+        i += length;
+    }
+    
+    return BigInt(std::move(magnitude), false);
+}
+
+BigInt BigInt::fromDouble(double value) {
+    value = std::trunc(value);
+    if (std::fabs(value) < 9223372036854775808.0) {
+        return BigInt(static_cast<int64_t>(value));
+    }
+    
+    // |value| >= 2^63: an exact 53-bit mantissa shifted left by `shift` bits
+    int exponent = 0;
+    double fraction = std::frexp(std::fabs(value), &exponent);
+    uint64_t mantissa = static_cast<uint64_t>(std::ldexp(fraction, 53));
+    int shift = exponent - 53;
+    
+    Limbs magnitude(static_cast<size_t>(shift / 32), 0);
+    int bits = shift % 32;
+    uint64_t low = mantissa << bits;
+    uint64_t high = bits == 0 ? 0 : mantissa >> (64 - bits);
+    magnitude.push_back(static_cast<uint32_t>(low));
+    magnitude.push_back(static_cast<uint32_t>(low >> 32));
+    magnitude.push_back(static_cast<uint32_t>(high));
+    return BigInt(std::move(magnitude), value < 0);
+}
+
+bool BigInt::fitsInt64() const {
+    if (limbs.size() <= 1) {
+        return true;
+    }
+    if (limbs.size() > 2) {
+        return false;
+    }
+    uint64_t magnitude = (static_cast<uint64_t>(limbs[1]) << 32) | limbs[0];
+    uint64_t limit = static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + (negative ? 1 : 0);
+    return magnitude <= limit;
+}
+
+int64_t BigInt::toInt64() const {
+    uint64_t magnitude = 0;
+    for (size_t i = limbs.size(); i-- > 0;) {
+        magnitude = (magnitude << 32) | limbs[i];
+    }
+    return negative ? static_cast<int64_t>(~magnitude + 1) : static_cast<int64_t>(magnitude);
+}
+
+double BigInt::toDouble() const {
+    if (fitsInt64()) {
+        return static_cast<double>(toInt64());
+    }
+    
+    // Going through the decimal text gives a correctly rounded result
+    double result = 0.0;
+    if (NumberFormat::parseFloat(toString(), result) == NumberFormat::ParseStatus::OUT_OF_RANGE) {
+        result = negative ? -HUGE_VAL : HUGE_VAL;
+    }
+    return result;
+}
+
+void BigInt::appendTo(std::string& out) const {
+    if (limbs.empty()) {
+        out += '0';
+        return;
+    }
+    
+    Limbs magnitude = limbs;
+    std::vector<uint32_t> chunks;
+    while (!magnitude.empty()) {
+        chunks.push_back(divideSmall(magnitude, DECIMAL_CHUNK));
+    }
+    
+    if (negative) {
+        out += '-';
+    }
+    out += std::to_string(chunks.back());
+    for (size_t i = chunks.size() - 1; i-- > 0;) {
+        std::string digits = std::to_string(chunks[i]);
+        out.append(DECIMAL_CHUNK_DIGITS - digits.size(), '0');
+        out += digits;
+    }
+}
+
+std::string BigInt::toString() const {
+    std::string text;
+    appendTo(text);
+    return text;
+}
+
+BigInt BigInt::add(const BigInt& left, const BigInt& right) {
+    if (left.negative == right.negative) {
+        return BigInt(addMagnitude(left.limbs, right.limbs), left.negative);
+    }
+    if (compareMagnitude(left.limbs, right.limbs) >= 0) {
+        return BigInt(subtractMagnitude(left.limbs, right.limbs), left.negative);
+    }
+    return BigInt(subtractMagnitude(right.limbs, left.limbs), right.negative);
+}
+
+BigInt BigInt::subtract(const BigInt& left, const BigInt& right) {
+    BigInt negated = right;
+    if (!negated.isZero()) {
+        negated.negative = !negated.negative;
+    }
+    return add(left, negated);
+}
+
+BigInt BigInt::multiply(const BigInt& left, const BigInt& right) {
+    return BigInt(multiplyMagnitude(left.limbs, right.limbs), left.negative != right.negative);
+}
+
+BigInt BigInt::divide(const BigInt& left, const BigInt& right) {
+    Limbs quotient;
+    Limbs rest;
+    divideMagnitude(left.limbs, right.limbs, quotient, rest);
+    return BigInt(std::move(quotient), left.negative != right.negative);
+}
+
+BigInt BigInt::remainder(const BigInt& left, const BigInt& right) {
+    Limbs quotient;
+    Limbs rest;
+    divideMagnitude(left.limbs, right.limbs, quotient, rest);
+    return BigInt(std::move(rest), left.negative);
+}
+
+int BigInt::compareMagnitude(const Limbs& left, const Limbs& right) {
+    if (left.size() != right.size()) {
+        return left.size() < right.size() ? -1 : 1;
+    }
+    for (size_t i = left.size(); i-- > 0;) {
+        if (left[i] != right[i]) {
+            return left[i] < right[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+BigInt::Limbs BigInt::addMagnitude(const Limbs& left, const Limbs& right) {
+    const Limbs& longer = left.size() >= right.size() ? left : right;
+    const Limbs& shorter = left.size() >= right.size() ? right : left;
+    
+    Limbs result(longer.size() + 1);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < longer.size(); ++i) {
+        uint64_t sum = carry + longer[i] + (i < shorter.size() ? shorter[i] : 0);
+        result[i] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+    }
+    result[longer.size()] = static_cast<uint32_t>(carry);
+    trim(result);
+    return result;
+}
+
+BigInt::Limbs BigInt::subtractMagnitude(const Limbs& left, const Limbs& right) {
+    Limbs result(left.size());
+    int64_t borrow = 0;
+    for (size_t i = 0; i < left.size(); ++i) {
+        int64_t difference = static_cast<int64_t>(left[i]) - borrow - (i < right.size() ? right[i] : 0);
+        borrow = difference < 0 ? 1 : 0;
+        result[i] = static_cast<uint32_t>(difference + (borrow ? LIMB_BASE : 0));
+    }
+    trim(result);
+    return result;
+}
+
+BigInt::Limbs BigInt::multiplyMagnitude(const Limbs& left, const Limbs& right) {
+    if (left.empty() || right.empty()) {
+        return Limbs();
+    }
+    
+    Limbs result(left.size() + right.size(), 0);
+    for (size_t i = 0; i < left.size(); ++i) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < right.size(); ++j) {
+            uint64_t product = static_cast<uint64_t>(left[i]) * right[j] + result[i + j] + carry;
+            result[i + j] = static_cast<uint32_t>(product);
+            carry = product >> 32;
+        }
+        result[i + right.size()] = static_cast<uint32_t>(carry);
+    }
+    trim(result);
+    return result;
+}
+
+// Knuth's Algorithm D (TAOCP vol. 2, 4.3.1) on 32-bit limbs
+void BigInt::divideMagnitude(const Limbs& left, const Limbs& right, Limbs& quotient, Limbs& rest) {
+    if (compareMagnitude(left, right) < 0) {
+        quotient.clear();
+        rest = left;
+        return;
+    }
+    
+    if (right.size() == 1) {
+        quotient = left;
+        uint32_t remainder = divideSmall(quotient, right[0]);
+        rest.clear();
+        if (remainder != 0) {
+            rest.push_back(remainder);
+        }
+        return;
+    }
+    
+    // Normalize so the divisor's top limb has its high bit set
+    const size_t n = right.size();
+    const size_t m = left.size() - n;
+    const int shift = __builtin_clz(right.back());
+    
+    Limbs divisor(n);
+    for (size_t i = n - 1; i > 0; --i) {
+        divisor[i] = static_cast<uint32_t>((static_cast<uint64_t>(right[i]) << shift) |
+                                           (static_cast<uint64_t>(right[i - 1]) >> (32 - shift)));
+    }
+    divisor[0] = right[0] << shift;
+    
+    Limbs dividend(left.size() + 1);
+    dividend[left.size()] = static_cast<uint32_t>(static_cast<uint64_t>(left.back()) >> (32 - shift));
+    for (size_t i = left.size() - 1; i > 0; --i) {
+        dividend[i] = static_cast<uint32_t>((static_cast<uint64_t>(left[i]) << shift) |
+                                            (static_cast<uint64_t>(left[i - 1]) >> (32 - shift)));
+    }
+    dividend[0] = left[0] << shift;
+    
+    quotient.assign(m + 1, 0);
+    for (size_t j = m + 1; j-- > 0;) {
+        // Estimate the quotient limb from the top two dividend limbs
+        uint64_t top = (static_cast<uint64_t>(dividend[j + n]) << 32) | dividend[j + n - 1];
+        uint64_t estimate = top / divisor[n - 1];
+        uint64_t estimate_rest = top % divisor[n - 1];
+        while (estimate >= LIMB_BASE ||
+               estimate * divisor[n - 2] > ((estimate_rest << 32) | dividend[j + n - 2])) {
+            estimate--;
+            estimate_rest += divisor[n - 1];
+            if (estimate_rest >= LIMB_BASE) {
+                break;
+            }
+        }
+        
+        // Multiply and subtract
+        int64_t borrow = 0;
+        int64_t difference = 0;
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t product = estimate * divisor[i];
+            difference = static_cast<int64_t>(dividend[i + j]) - borrow -
+                         static_cast<int64_t>(product & 0xFFFFFFFF);
+            dividend[i + j] = static_cast<uint32_t>(difference);
+            borrow = static_cast<int64_t>(product >> 32) - (difference >> 32);
+        }
+        difference = static_cast<int64_t>(dividend[j + n]) - borrow;
+        dividend[j + n] = static_cast<uint32_t>(difference);
+        
+        // The estimate was one too large; add the divisor back
+        if (difference < 0) {
+            estimate--;
+            uint64_t carry = 0;
+            for (size_t i = 0; i < n; ++i) {
+                uint64_t sum = static_cast<uint64_t>(dividend[i + j]) + divisor[i] + carry;
+                dividend[i + j] = static_cast<uint32_t>(sum);
+                carry = sum >> 32;
+            }
+            dividend[j + n] += static_cast<uint32_t>(carry);
+        }
+        quotient[j] = static_cast<uint32_t>(estimate);
+    }
+    trim(quotient);
+    
+    // Unnormalize the remainder
+    rest.assign(n, 0);
+    for (size_t i = 0; i < n; ++i) {
+        rest[i] = static_cast<uint32_t>((static_cast<uint64_t>(dividend[i]) >> shift) |
+                                        (static_cast<uint64_t>(dividend[i + 1]) << (32 - shift)));
+    }
+    trim(rest);
+}
+
+uint32_t BigInt::divideSmall(Limbs& magnitude, uint32_t divisor) {
+    uint64_t remainder = 0;
+    for (size_t i = magnitude.size(); i-- > 0;) {
+        uint64_t current = (remainder << 32) | magnitude[i];
+        magnitude[i] = static_cast<uint32_t>(current / divisor);
+        remainder = current % divisor;
+    }
+    trim(magnitude);
+    return static_cast<uint32_t>(remainder);
+}
+
+void BigInt::multiplyAddSmall(Limbs& magnitude, uint32_t factor, uint32_t addend) {
+    uint64_t carry = addend;
+    for (uint32_t& limb : magnitude) {
+        uint64_t product = static_cast<uint64_t>(limb) * factor + carry;
+        limb = static_cast<uint32_t>(product);
+        carry = product >> 32;
+    }
+    if (carry != 0) {
+        magnitude.push_back(static_cast<uint32_t>(carry));
+    }
+}
+
+void BigInt::trim(Limbs& magnitude) {
+    while (!magnitude.empty() && magnitude.back() == 0) {
+        magnitude.pop_back();
+    }
+}
+
+} // namespace Lizard
@@ -0,0 +1,36 @@
+#include "constant_pool.h"
+
+namespace Lizard {
+
+uint32_t ConstantPool::add(const Value& value) {
+    uint32_t index = static_cast<uint32_t>(values.size());
+    
+    if (value.isString()) {
+        auto inserted = string_indices.emplace(value.asString(), index);
+        if (!inserted.second) {
+            return inserted.first->second;
+        }
+    } else if (value.isBigInteger()) {
+        auto inserted = bigint_indices.emplace(value.asBigInt().toString(), index);
+        if (!inserted.second) {
+            return inserted.first->second;
+        }
+    } else {
+        auto inserted = scalar_indices.emplace(value.raw(), index);
+        if (!inserted.second) {
+            return inserted.first->second;
+        }
+    }
+    
+    values.push_back(value);
+    return index;
+}
+
+void ConstantPool::clear() {
+    values.clear();
+    scalar_indices.clear();
+    string_indices.clear();
+    bigint_indices.clear();
+}
+
+} // namespace Lizard
@@ -1,23 +1,37 @@
 #include "environment.h"
 #include "error_handler.h"
+#include <algorithm>
 
 namespace Lizard {
 
-void Environment::define(const std::string& name, const Value& value, bool is_constant, const Position& pos) {
-    if (exists(name)) {
-        ErrorHandler::reportError("Variable '" + name + "' is already defined", pos);
+void Environment::reset(const std::vector<std::string>& slot_names,
+                        const std::vector<Variable>* prelude) {
+    names = &slot_names;
+    variables.assign(slot_names.size(), Variable());
+    if (prelude) {
+        std::copy(prelude->begin(), prelude->end(), variables.begin());
     }
-    
-    variables.emplace(name, Variable(value, is_constant, true, pos));
 }
 
-void Environment::assign(const std::string& name, const Value& value, const Position& assign_pos) {
-    auto it = variables.find(name);
-    if (it == variables.end()) {
-        ErrorHandler::reportError("Undefined variable '" + name + "'", assign_pos);
+void Environment::define(uint32_t slot, const Value& value, bool is_constant, bool is_initialized,
+                         const Position& pos) {
+    Variable& var = variables[slot];
+    if (var.is_defined) {
+        ErrorHandler::reportError("Variable '" + (*names)[slot] + "' is already defined", pos);
     }
     
-    Variable& var = it->second;
+    var.value = value;
+    var.is_defined = true;
+    var.is_constant = is_constant;
+    var.is_initialized = is_initialized;
+    var.declaration_position = pos;
+}
+
+void Environment::assign(uint32_t slot, const Value& value, const Position& assign_pos) {
+    Variable& var = variables[slot];
+    if (!var.is_defined) {
+        ErrorHandler::reportError("Undefined variable '" + (*names)[slot] + "'", assign_pos);
+    }
     
     if (var.is_constant && var.is_initialized) {
         ErrorHandler::reportErrorWithNote(
@@ -32,35 +46,18 @@ void Environment::assign(const std::string& name, const Value& value, const Posi
     var.is_initialized = true;
 }
 
-Value Environment::get(const std::string& name, const Position& access_pos) {
-    auto it = variables.find(name);
-    if (it == variables.end()) {
-        ErrorHandler::reportError("Undefined variable '" + name + "'", access_pos);
+void Environment::reportInvalidAccess(uint32_t slot, const Position& access_pos) const {
+    const Variable& var = variables[slot];
+    if (!var.is_defined) {
+        ErrorHandler::reportError("Undefined variable '" + (*names)[slot] + "'", access_pos);
     }
     
-    Variable& var = it->second;
-    if (!var.is_initialized) {
-        ErrorHandler::reportErrorWithNote(
-            "Variable '" + name + "' is used before being initialized.",
-            access_pos,
-            "Variable declared here.",
-            var.declaration_position
-        );
-    }
-    
-    return var.value;
-}
-
-bool Environment::exists(const std::string& name) const {
-    return variables.find(name) != variables.end();
-}
-
-Variable* Environment::getVariable(const std::string& name) {
-    auto it = variables.find(name);
-    if (it == variables.end()) {
-        return nullptr;
-    }
-    return &it->second;
+    ErrorHandler::reportErrorWithNote(
+        "Variable '" + (*names)[slot] + "' is used before being initialized.",
+        access_pos,
+        "Variable declared here.",
+        var.declaration_position
+    );
 }
 
-} // namespace Lizard
\ No newline at end of file
+} // namespace Lizard
@@ -0,0 +1,55 @@
+#include "number_format.h"
+#include <charconv>
+
+namespace Lizard {
+
+namespace NumberFormat {
+
+char* formatInt(char* out, int64_t value) {
+    return std::to_chars(out, out + MAX_CHARS, value).ptr;
+}
+
+char* formatFloat(char* out, double value) {
+    // Without a precision to_chars picks the shortest round-trip text,
+    // choosing fixed or scientific notation by length
+    return std::to_chars(out, out + MAX_CHARS, value).ptr;
+}
+
+void appendInt(std::string& out, int64_t value) {
+    char buffer[MAX_CHARS];
+    out.append(buffer, formatInt(buffer, value));
+}
+
+void appendFloat(std::string& out, double value) {
+    char buffer[MAX_CHARS];
+    out.append(buffer, formatFloat(buffer, value));
+}
+
+namespace {
+
+template<typename T>
+ParseStatus parse(std::string_view text, T& value) {
+    const char* end = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), end, value);
+    if (ec == std::errc::result_out_of_range) {
+        return ParseStatus::OUT_OF_RANGE;
+    }
+    if (ec != std::errc() || ptr != end) {
+        return ParseStatus::INVALID;
+    }
+    return ParseStatus::OK;
+}
+
+} // namespace
+
+ParseStatus parseInt(std::string_view text, int64_t& value) {
+    return parse(text, value);
+}
+
+ParseStatus parseFloat(std::string_view text, double& value) {
+    return parse(text, value);
+}
+
+} // namespace NumberFormat
+
+} // namespace Lizard
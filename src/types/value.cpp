@@ -1,51 +1,78 @@
 #include "value.h"
-#include <sstream>
+#include "number_format.h"
 
 namespace Lizard {
 
-Value::Value() : data(nullptr) {}
+static_assert(sizeof(Value) == 8, "Value must fit in one machine word");
 
-Value::Value(const std::string& str) : data(str) {}
+Value::Value(const std::string& str)
+    : bits(STRING_TAG | reinterpret_cast<uintptr_t>(new StringObject(str))) {}
 
-Value::Value(int i) : data(i) {}
+Value::Value(std::string&& str)
+    : bits(STRING_TAG | reinterpret_cast<uintptr_t>(new StringObject(std::move(str)))) {}
 
-Value::Value(double f) : data(f) {}
+Value::Value(const char* str) : Value(std::string(str)) {}
 
-Value::Value(bool b) : data(b) {}
+uint64_t Value::boxBigInteger(int64_t i) {
+    return BIGINT_TAG | reinterpret_cast<uintptr_t>(new BigIntObject(BigInt(i)));
+}
 
-Value::Value(std::nullptr_t) : data(nullptr) {}
+Value::Value(BigInt&& n) {
+    // Results that fit go back to being immediates
+    if (n.fitsInt64() && fitsSmallInteger(n.toInt64())) {
+        bits = smallIntegerBits(n.toInt64());
+    } else {
+        bits = BIGINT_TAG | reinterpret_cast<uintptr_t>(new BigIntObject(std::move(n)));
+    }
+}
 
-ValueType Value::getType() const {
-    if (std::holds_alternative<std::string>(data)) {
-        return ValueType::STRING;
-    } else if (std::holds_alternative<int>(data)) {
-        return ValueType::INTEGER;
-    } else if (std::holds_alternative<double>(data)) {
-        return ValueType::FLOAT;
-    } else if (std::holds_alternative<bool>(data)) {
-        return ValueType::BOOLEAN;
+Value::Value(double f) {
+    if (f != f) {
+        bits = CANONICAL_NAN;
     } else {
-        return ValueType::NIL;
+        std::memcpy(&bits, &f, sizeof(bits));
+    }
+}
+
+void Value::destroy() {
+    if (isString()) {
+        delete static_cast<StringObject*>(heapObject());
+    } else {
+        delete static_cast<BigIntObject*>(heapObject());
     }
 }
 
 std::string Value::toString() const {
+    if (isString()) {
+        return asString();
+    }
+    std::string text;
+    appendTo(text);
+    return text;
+}
+
+void Value::appendTo(std::string& out) const {
     switch (getType()) {
         case ValueType::STRING:
-            return std::get<std::string>(data);
+            out += asString();
+            return;
         case ValueType::INTEGER:
-            return std::to_string(std::get<int>(data));
-        case ValueType::FLOAT: {
-            std::ostringstream oss;
-            oss << std::get<double>(data);
-            return oss.str();
-        }
+            if (isBigInteger()) {
+                asBigInt().appendTo(out);
+            } else {
+                NumberFormat::appendInt(out, get<int64_t>());
+            }
+            return;
+        case ValueType::FLOAT:
+            NumberFormat::appendFloat(out, get<double>());
+            return;
         case ValueType::BOOLEAN:
-            return std::get<bool>(data) ? "true" : "false";
+            out += get<bool>() ? "true" : "false";
+            return;
         case ValueType::NIL:
-            return "nil";
+            out += "nil";
+            return;
     }
-    return "nil";
 }
 
-} // namespace Lizard
\ No newline at end of file
+} // namespace Lizard
@@ -0,0 +1,86 @@
+#include "vm.h"
+#include "eval_arithmetic.h"
+#include "error_handler.h"
+
+namespace Lizard {
+
+void VirtualMachine::run(const Chunk& chunk) {
+    registers.assign(chunk.register_count, Value(nullptr));
+    environment.reset(chunk.names, prelude);
+    sites.assign(chunk.code.size(), BinarySite());
+
+    const Instruction* code = chunk.code.data();
+    const size_t count = chunk.code.size();
+
+    jit = jit_enabled ? std::make_unique<Jit>(chunk) : nullptr;
+    size_t next_region = jit ? jit->nextRegion(0) : Jit::NO_REGION;
+
+    for (size_t pc = 0; pc < count; ++pc) {
+        if (pc == next_region) {
+            size_t resume = jit->run(pc, registers.data(), environment.data());
+            next_region = jit->nextRegion(pc + 1);
+            if (resume != pc) {
+                pc = resume - 1;
+                continue;
+            }
+            // The region's first instruction failed a guard; interpret it
+        }
+
+        const Instruction& ins = code[pc];
+
+        switch (ins.op) {
+            case OpCode::LOAD_CONST:
+                registers[ins.a] = chunk.constants[ins.b];
+                break;
+            case OpCode::GET_VAR:
+                registers[ins.a] = environment.get(ins.b, chunk.positions[pc]);
+                break;
+            case OpCode::DEFINE_VAR:
+                environment.define(ins.b, registers[ins.a], ins.c != 0, true, chunk.positions[pc]);
+                break;
+            case OpCode::DECLARE_VAR:
+                environment.define(ins.b, Value(nullptr), ins.c != 0, false, chunk.positions[pc]);
+                break;
+            case OpCode::SET_VAR:
+                environment.assign(ins.b, registers[ins.a], chunk.positions[pc]);
+                break;
+            case OpCode::ADD:
+                registers[ins.a] = binary(BinaryOperator::ADD, ins, pc, chunk.positions[pc]);
+                break;
+            case OpCode::SUBTRACT:
+                registers[ins.a] = binary(BinaryOperator::SUBTRACT, ins, pc, chunk.positions[pc]);
+                break;
+            case OpCode::MULTIPLY:
+                registers[ins.a] = binary(BinaryOperator::MULTIPLY, ins, pc, chunk.positions[pc]);
+                break;
+            case OpCode::DIVIDE:
+                registers[ins.a] = binary(BinaryOperator::DIVIDE, ins, pc, chunk.positions[pc]);
+                break;
+            case OpCode::INT_DIV:
+                registers[ins.a] = binary(BinaryOperator::INT_DIV, ins, pc, chunk.positions[pc]);
+                break;
+            case OpCode::MODULO:
+                registers[ins.a] = binary(BinaryOperator::MODULO, ins, pc, chunk.positions[pc]);
+                break;
+            case OpCode::PRINT:
+                output.writeLine(registers[ins.a]);
+                break;
+        }
+    }
+}
+
+void VirtualMachine::printProfile(std::ostream& out) const {
+    TypeFeedback::printReport(out, sites);
+    if (jit) {
+        out << "JIT: " << jit->regionCount() << " regions, " << jit->compiledBytes() << " bytes of native code\n";
+    }
+}
+
+Value VirtualMachine::binary(BinaryOperator op, const Instruction& ins, size_t pc, const Position& pos) {
+    if (ins.types.known()) {
+        return ArithmeticEvaluator::evaluate(op, ins.types, registers[ins.b], registers[ins.c], pos);
+    }
+    return TypeFeedback::evaluate(sites[pc], op, registers[ins.b], registers[ins.c], pos);
+}
+
+} // namespace Lizard
@@ -0,0 +1,34 @@
+#!/bin/sh
+# Differential test for `lizard build`: the executable built from a script
+# must print the same stdout and stderr and exit with the same status as
+# running the script with `lizard`. A script the build rejects must be
+# rejected the same way the interpreter rejects it.
+#
+# Usage: aot_diff.sh <lizard> <script.lz>
+set -u
+
+lizard=$1
+script=$2
+work=$(mktemp -d) || exit 1
+trap 'rm -rf "$work"' EXIT
+
+"$lizard" --no-cache "$script" >"$work/expected.out" 2>"$work/expected.err"
+echo "exit $?" >"$work/expected.status"
+
+"$lizard" build --no-cache -o "$work/program" "$script" >"$work/actual.out" 2>"$work/actual.err"
+result=$?
+if [ $result -eq 0 ]; then
+    "$work/program" >"$work/actual.out" 2>"$work/actual.err"
+    result=$?
+fi
+echo "exit $result" >"$work/actual.status"
+
+status=0
+for part in out err status; do
+    if ! cmp -s "$work/expected.$part" "$work/actual.$part"; then
+        echo "$script: $part differs between lizard and the built executable"
+        diff "$work/expected.$part" "$work/actual.$part"
+        status=1
+    fi
+done
+exit $status
@@ -0,0 +1,28 @@
+#!/bin/sh
+# Regression test: every engine must print exactly <script>.expected, which
+# holds stdout and stderr together followed by an "exit <status>" line.
+# Runs from the script's directory so error messages name it the same way
+# wherever the tree is checked out.
+#
+# Usage: expect_output.sh <lizard> <script.lz>
+set -u
+
+lizard=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+cd "$(dirname "$2")" || exit 1
+script=$(basename "$2")
+expected=${script%.lz}.expected
+actual=$(mktemp) || exit 1
+trap 'rm -f "$actual"' EXIT
+
+status=0
+for mode in "--engine=tree" "--engine=vm" "--engine=vm --jit" "--stream"; do
+    # $mode is split into separate options on purpose
+    "$lizard" --no-cache $mode "$script" >"$actual" 2>&1
+    echo "exit $?" >>"$actual"
+    if ! cmp -s "$expected" "$actual"; then
+        echo "$script: output with $mode differs from $expected"
+        diff "$expected" "$actual"
+        status=1
+    fi
+done
+exit $status